@@ -0,0 +1,272 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Kitchen.h"
+#include "BuildInteractableIndexCommandlet.h"
+#include "InteractableIndex.h"
+#include "ItemCatalog.h"
+#include "PhysicsEngine/PhysicsConstraintComponent.h"
+#if WITH_EDITOR
+#include "AssetRegistryModule.h"
+#endif
+
+UBuildInteractableIndexCommandlet::UBuildInteractableIndexCommandlet()
+{
+	IsClient = false;
+	IsEditor = true;
+	LogToConsole = true;
+}
+
+int32 UBuildInteractableIndexCommandlet::Main(const FString& Params)
+{
+#if WITH_EDITOR
+	FString Path = TEXT("/Game/Levels");
+	FParse::Value(*Params, TEXT("Path="), Path);
+	const bool bCheck = FParse::Param(*Params, TEXT("Check"));
+
+	//Meshes of the catalog identify the items which were not tagged
+	const UDataTable* Table = Cast<UDataTable>(GetDefault<AItemCatalog>()->ItemTable.TryLoad());
+	if (Table && Table->RowStruct == FKitchenItemRow::StaticStruct())
+	{
+		for (const auto& Entry : Table->RowMap)
+		{
+			const FKitchenItemRow* Row = reinterpret_cast<const FKitchenItemRow*>(Entry.Value);
+			if (!Row->Mesh.IsNull())
+			{
+				CatalogMeshes.Add(Row->Mesh.ToStringReference().ToString());
+			}
+		}
+	}
+	else if (GetDefault<AItemCatalog>()->ItemTable.IsValid())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Item catalog %s could not be loaded, untagged items are not detected"), *GetDefault<AItemCatalog>()->ItemTable.ToString());
+	}
+
+	IAssetRegistry& AssetRegistry = FModuleManager::LoadModuleChecked<FAssetRegistryModule>(TEXT("AssetRegistry")).Get();
+	AssetRegistry.SearchAllAssets(true);
+
+	FARFilter Filter;
+	Filter.PackagePaths.Add(FName(*Path));
+	Filter.ClassNames.Add(UWorld::StaticClass()->GetFName());
+	Filter.bRecursivePaths = true;
+	TArray<FAssetData> Assets;
+	AssetRegistry.GetAssets(Filter, Assets);
+
+	int32 NumErrors = 0;
+	int32 NumSaved = 0;
+	for (const FAssetData& Asset : Assets)
+	{
+		const UWorld* World = Cast<UWorld>(Asset.GetAsset());
+		if (!World || !World->PersistentLevel)
+		{
+			UE_LOG(LogTemp, Error, TEXT("Could not load %s"), *Asset.ObjectPath.ToString());
+			NumErrors++;
+			continue;
+		}
+
+		UInteractableIndex* Built = NewObject<UInteractableIndex>(GetTransientPackage());
+		const int32 NumLevelErrors = BuildIndex(World->PersistentLevel, Built);
+		NumErrors += NumLevelErrors;
+		UE_LOG(LogTemp, Display, TEXT("%s: %d interactables, %d constraints, %d errors"), *Asset.PackageName.ToString(), Built->Entries.Num(), Built->ConstraintActors.Num(), NumLevelErrors);
+
+		if (bCheck)
+		{
+			//An index which differs from the rebuilt one would register the wrong actors, or trigger a scan, at runtime
+			const UInteractableIndex* Saved = UInteractableIndex::LoadForPackage(Asset.PackageName.ToString());
+			if (!Saved)
+			{
+				UE_LOG(LogTemp, Error, TEXT("%s has no interactable index"), *Asset.PackageName.ToString());
+				NumErrors++;
+			}
+			else if (!Saved->HasSameContent(Built))
+			{
+				UE_LOG(LogTemp, Error, TEXT("The interactable index of %s is out of date"), *Asset.PackageName.ToString());
+				NumErrors++;
+			}
+		}
+		else if (SaveIndex(Asset.PackageName.ToString(), Built))
+		{
+			NumSaved++;
+		}
+	}
+
+	UE_LOG(LogTemp, Display, TEXT("Interactable index built for %d levels under %s, %d saved, %d errors"), Assets.Num(), *Path, NumSaved, NumErrors);
+	return NumErrors > 0 ? 1 : 0;
+#else
+	UE_LOG(LogTemp, Error, TEXT("BuildInteractableIndex needs the editor"));
+	return 1;
+#endif
+}
+
+int32 UBuildInteractableIndexCommandlet::BuildIndex(ULevel* Level, UInteractableIndex* Index) const
+{
+	int32 NumErrors = 0;
+	const FString LevelName = FPackageName::GetShortName(Level->GetOutermost()->GetName());
+
+	//Constraints first, the drawers and doors are checked against the actors they hold
+	TSet<const AActor*> ConstrainedActors;
+	for (const AActor* Actor : Level->Actors)
+	{
+		if (!Actor)
+		{
+			continue;
+		}
+		TInlineComponentArray<UPhysicsConstraintComponent*> ActorConstraints;
+		Actor->GetComponents(ActorConstraints);
+		for (const UPhysicsConstraintComponent* Constraint : ActorConstraints)
+		{
+			if (Constraint->ConstraintActor1)
+			{
+				ConstrainedActors.Add(Constraint->ConstraintActor1);
+			}
+			if (Constraint->ConstraintActor2)
+			{
+				ConstrainedActors.Add(Constraint->ConstraintActor2);
+			}
+		}
+		if (ActorConstraints.Num() > 0)
+		{
+			Index->ConstraintActors.Add(Actor->GetFName());
+		}
+		if (UInteractableIndex::IsCandidate(Actor))
+		{
+			Index->CandidateActors.Add(Actor->GetFName());
+		}
+	}
+	Index->CandidateActors.Sort([](const FName& A, const FName& B) { return A.Compare(B) < 0; });
+
+	TSet<const AActor*> Openables;
+	for (const AActor* Actor : Level->Actors)
+	{
+		if (!Actor)
+		{
+			continue;
+		}
+		const UStaticMeshComponent* Mesh = Actor->FindComponentByClass<UStaticMeshComponent>();
+		const bool bCatalogMesh = Mesh && Mesh->StaticMesh && CatalogMeshes.Contains(Mesh->StaticMesh->GetPathName());
+
+		//Set up in the editor, the actor registers itself
+		if (Actor->FindComponentByClass<UInteractableComponent>())
+		{
+			continue;
+		}
+
+		EInteractableKind Kind;
+		if (!UInteractableIndex::ClassifyActor(Actor, Kind))
+		{
+			if (Actor->GetName().Contains(TEXT("Handle")))
+			{
+				UE_LOG(LogTemp, Error, TEXT("%s: %s is named as a handle but is not attached to a drawer or door, or has no mesh"), *LevelName, *Actor->GetName());
+				NumErrors++;
+			}
+			else if (bCatalogMesh)
+			{
+				UE_LOG(LogTemp, Error, TEXT("%s: %s uses the item mesh %s but has no Item tag"), *LevelName, *Actor->GetName(), *Mesh->StaticMesh->GetName());
+				NumErrors++;
+			}
+			continue;
+		}
+
+		FInteractableIndexEntry& Entry = Index->Entries[Index->Entries.AddDefaulted()];
+		Entry.ActorName = Actor->GetFName();
+		Entry.Kind = Kind;
+
+		if (Kind == EInteractableKind::Handle)
+		{
+			if (Actor->ActorHasTag(FName(TEXT("Item"))))
+			{
+				UE_LOG(LogTemp, Error, TEXT("%s: %s has the Item tag but is named as a handle, it is used as a handle"), *LevelName, *Actor->GetName());
+				NumErrors++;
+			}
+
+			//The drawer or door is checked once, whatever number of handles it has
+			const AActor* Openable = Actor->GetAttachParentActor();
+			if (Openables.Contains(Openable))
+			{
+				continue;
+			}
+			Openables.Add(Openable);
+
+			const UStaticMeshComponent* OpenableMesh = Openable->FindComponentByClass<UStaticMeshComponent>();
+			if (!OpenableMesh || !OpenableMesh->StaticMesh)
+			{
+				UE_LOG(LogTemp, Error, TEXT("%s: %s, opened by %s, has no mesh"), *LevelName, *Openable->GetName(), *Actor->GetName());
+				NumErrors++;
+			}
+			else if (!OpenableMesh->BodyInstance.bSimulatePhysics)
+			{
+				UE_LOG(LogTemp, Error, TEXT("%s: %s, opened by %s, does not simulate physics and cannot move"), *LevelName, *Openable->GetName(), *Actor->GetName());
+				NumErrors++;
+			}
+			if (!ConstrainedActors.Contains(Openable))
+			{
+				UE_LOG(LogTemp, Warning, TEXT("%s: %s, opened by %s, is not held by a constraint and only opens by its mass"), *LevelName, *Openable->GetName(), *Actor->GetName());
+			}
+		}
+		else if (!Mesh || !Mesh->StaticMesh)
+		{
+			UE_LOG(LogTemp, Error, TEXT("%s: item %s has no mesh"), *LevelName, *Actor->GetName());
+			NumErrors++;
+		}
+		else
+		{
+			if (!Mesh->BodyInstance.bSimulatePhysics || Mesh->Mobility != EComponentMobility::Movable)
+			{
+				UE_LOG(LogTemp, Error, TEXT("%s: item %s is not a movable body simulating physics and cannot be picked"), *LevelName, *Actor->GetName());
+				NumErrors++;
+			}
+			if (!bCatalogMesh && CatalogMeshes.Num() > 0)
+			{
+				UE_LOG(LogTemp, Warning, TEXT("%s: item %s uses %s, which is not in the item catalog, it gets the default grip"), *LevelName, *Actor->GetName(), *Mesh->StaticMesh->GetName());
+			}
+		}
+	}
+
+	//Drawers and doors need a handle to be opened
+	for (const AActor* Actor : Level->Actors)
+	{
+		if (Actor && !Openables.Contains(Actor) && !Actor->GetName().Contains(TEXT("Handle"))
+			&& (Actor->GetName().Contains(TEXT("Drawer")) || Actor->GetName().Contains(TEXT("Door")))
+			&& !Actor->FindComponentByClass<UInteractableComponent>())
+		{
+			UE_LOG(LogTemp, Warning, TEXT("%s: %s is named as a drawer or door but no handle is attached to it"), *LevelName, *Actor->GetName());
+		}
+	}
+	return NumErrors;
+}
+
+bool UBuildInteractableIndexCommandlet::SaveIndex(const FString& LevelPackageName, const UInteractableIndex* Built) const
+{
+#if WITH_EDITOR
+	const FString PackageName = UInteractableIndex::GetIndexPackageName(LevelPackageName);
+	const FString AssetName = FPackageName::GetShortName(PackageName);
+
+	//An existing index is updated in place, so references to it stay valid
+	UPackage* Package = FPackageName::DoesPackageExist(PackageName) ? LoadPackage(nullptr, *PackageName, LOAD_None) : CreatePackage(nullptr, *PackageName);
+	if (!Package)
+	{
+		UE_LOG(LogTemp, Error, TEXT("Could not create %s"), *PackageName);
+		return false;
+	}
+
+	UInteractableIndex* Index = FindObject<UInteractableIndex>(Package, *AssetName);
+	if (!Index)
+	{
+		Index = NewObject<UInteractableIndex>(Package, *AssetName, RF_Public | RF_Standalone);
+		FAssetRegistryModule::AssetCreated(Index);
+	}
+	Index->Entries = Built->Entries;
+	Index->ConstraintActors = Built->ConstraintActors;
+	Index->CandidateActors = Built->CandidateActors;
+	Package->MarkPackageDirty();
+
+	const FString FileName = FPackageName::LongPackageNameToFilename(PackageName, FPackageName::GetAssetPackageExtension());
+	if (!UPackage::SavePackage(Package, Index, RF_Standalone, *FileName))
+	{
+		UE_LOG(LogTemp, Error, TEXT("Could not save %s"), *FileName);
+		return false;
+	}
+	return true;
+#else
+	return false;
+#endif
+}
@@ -0,0 +1,38 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "Commandlets/Commandlet.h"
+#include "BuildInteractableIndexCommandlet.generated.h"
+
+class UInteractableIndex;
+
+/**
+ * Classifies the actors of every level into handles, drawers, doors and items with the rules the
+ * registry uses at runtime, checks that they can be used (mesh, physics, Item tag on catalog
+ * meshes, constraint on drawers and doors) and saves the interactable index of each level next to
+ * it. Run from the editor binary before cooking:
+ *   UE4Editor-Cmd.exe Kitchen.uproject -run=BuildInteractableIndex [-Path=/Game/Levels] [-Check]
+ * -Check saves nothing, it validates and compares the saved indexes with the rebuilt ones.
+ * Returns 1 if an actor is misclassified or unusable, or with -Check if an index is missing or out of date.
+ */
+UCLASS()
+class UBuildInteractableIndexCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UBuildInteractableIndexCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+
+private:
+	//Classifies and validates the actors of a level into the index; returns the number of errors
+	int32 BuildIndex(ULevel* Level, UInteractableIndex* Index) const;
+
+	//Saves the index of a level next to it; returns false if it could not be saved
+	bool SaveIndex(const FString& LevelPackageName, const UInteractableIndex* Built) const;
+
+	//Meshes of the item catalog, by path
+	TSet<FString> CatalogMeshes;
+};
@@ -0,0 +1,139 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Kitchen.h"
+#include "FixedStepSimulation.h"
+#include "PhysicsEngine/PhysicsSettings.h"
+
+AFixedStepSimulation::AFixedStepSimulation()
+{
+	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.TickGroup = TG_PostUpdateWork;
+
+	StepSeconds = 1.f / 60.f;
+	ReportInterval = 10.f;
+
+	SimulatedSeconds = 0.0;
+	StartSeconds = 0.0;
+	NumFrames = 0;
+	ReportSimulatedSeconds = 0.0;
+	ReportWallSeconds = 0.0;
+	bSavedSmoothFrameRate = false;
+	SavedMaxFPS = 0.f;
+}
+
+//Frame rate cap of the engine, lifted while the mode runs
+static IConsoleVariable* GetMaxFPSVariable()
+{
+	static IConsoleVariable* MaxFPSVar = IConsoleManager::Get().FindConsoleVariable(TEXT("t.MaxFPS"));
+	return MaxFPSVar;
+}
+
+bool AFixedStepSimulation::IsFixedStepRequested()
+{
+	float Unused;
+	return FParse::Param(FCommandLine::Get(), TEXT("KitchenFixedStep")) || FParse::Value(FCommandLine::Get(), TEXT("KitchenFixedStep="), Unused);
+}
+
+void AFixedStepSimulation::BeginPlay()
+{
+	Super::BeginPlay();
+
+	FParse::Value(FCommandLine::Get(), TEXT("KitchenFixedStep="), StepSeconds);
+	StepSeconds = FMath::Max(StepSeconds, 0.001f);
+
+	//A longer step would be cut by physics and the episode would no longer match the game time
+	const float MaxPhysicsDeltaTime = UPhysicsSettings::Get()->MaxPhysicsDeltaTime;
+	if (StepSeconds > MaxPhysicsDeltaTime)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Fixed step of %.4f s is longer than the physics limit of %.4f s, physics will run slower than the game"), StepSeconds, MaxPhysicsDeltaTime);
+	}
+
+	//The engine takes the fixed step as the frame time and never sleeps to match the wall clock
+	FApp::SetUseFixedTimeStep(true);
+	FApp::SetFixedDeltaTime(StepSeconds);
+
+	bSavedSmoothFrameRate = GEngine->bSmoothFrameRate;
+	GEngine->bSmoothFrameRate = false;
+	if (GetMaxFPSVariable())
+	{
+		SavedMaxFPS = GetMaxFPSVariable()->GetFloat();
+		GetMaxFPSVariable()->Set(0.f);
+	}
+
+	StartSeconds = FPlatformTime::Seconds();
+	ReportWallSeconds = StartSeconds;
+	UE_LOG(LogTemp, Log, TEXT("Fixed step simulation: %.4f s per frame"), StepSeconds);
+}
+
+void AFixedStepSimulation::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	Report();
+	WriteCsv();
+
+	FApp::SetUseFixedTimeStep(false);
+	GEngine->bSmoothFrameRate = bSavedSmoothFrameRate;
+	if (GetMaxFPSVariable())
+	{
+		GetMaxFPSVariable()->Set(SavedMaxFPS);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void AFixedStepSimulation::Tick(float DeltaSeconds)
+{
+	Super::Tick(DeltaSeconds);
+
+	SimulatedSeconds += DeltaSeconds;
+	NumFrames++;
+	if (ReportInterval > 0.f && FPlatformTime::Seconds() - ReportWallSeconds >= ReportInterval)
+	{
+		Report();
+	}
+}
+
+float AFixedStepSimulation::GetThroughput() const
+{
+	const double WallSeconds = FPlatformTime::Seconds() - StartSeconds;
+	return WallSeconds > 0.0 ? static_cast<float>(SimulatedSeconds / WallSeconds) : 0.f;
+}
+
+void AFixedStepSimulation::Report()
+{
+	const double NowSeconds = FPlatformTime::Seconds();
+	const double IntervalWallSeconds = NowSeconds - ReportWallSeconds;
+	const double IntervalSimulatedSeconds = SimulatedSeconds - ReportSimulatedSeconds;
+
+	UE_LOG(LogTemp, Log, TEXT("Fixed step simulation: %.1f s simulated in %.1f s, %.2f simulated s per wall s (%.2f over the last %.1f s)"),
+		SimulatedSeconds, NowSeconds - StartSeconds, GetThroughput(),
+		IntervalWallSeconds > 0.0 ? IntervalSimulatedSeconds / IntervalWallSeconds : 0.0, IntervalWallSeconds);
+
+	ReportSimulatedSeconds = SimulatedSeconds;
+	ReportWallSeconds = NowSeconds;
+}
+
+void AFixedStepSimulation::WriteCsv() const
+{
+	FString CsvPath;
+	if (!FParse::Value(FCommandLine::Get(), TEXT("FixedStepCsv="), CsvPath))
+	{
+		return;
+	}
+
+	const double WallSeconds = FPlatformTime::Seconds() - StartSeconds;
+	FString Csv = TEXT("Metric,Value\n");
+	Csv += FString::Printf(TEXT("Frames,%d\n"), NumFrames);
+	Csv += FString::Printf(TEXT("Step (s),%.6f\n"), StepSeconds);
+	Csv += FString::Printf(TEXT("Simulated Duration (s),%.3f\n"), SimulatedSeconds);
+	Csv += FString::Printf(TEXT("Wall Duration (s),%.3f\n"), WallSeconds);
+	Csv += FString::Printf(TEXT("Speedup,%.2f\n"), GetThroughput());
+
+	if (FFileHelper::SaveStringToFile(Csv, *CsvPath))
+	{
+		UE_LOG(LogTemp, Log, TEXT("Fixed step results written to %s"), *CsvPath);
+	}
+	else
+	{
+		UE_LOG(LogTemp, Error, TEXT("Fixed step simulation could not write %s"), *CsvPath);
+	}
+}
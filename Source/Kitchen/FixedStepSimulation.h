@@ -0,0 +1,66 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "GameFramework/Info.h"
+#include "FixedStepSimulation.generated.h"
+
+/**
+ * Runs the world with a constant time step and without waiting for the wall clock, for the
+ * generation of synthetic episodes. Every frame advances the game and physics by StepSeconds,
+ * so the same inputs give the same episode at any speed; with -nullrhi the world runs as fast as
+ * the game thread allows. The throughput, simulated seconds per wall-clock second, is logged every
+ * ReportInterval and when the world ends, and written to -FixedStepCsv=<file> when given.
+ * Started with -KitchenFixedStep, or -KitchenFixedStep=<seconds> to override the step.
+ */
+UCLASS(config = Game)
+class KITCHEN_API AFixedStepSimulation : public AInfo
+{
+	GENERATED_BODY()
+
+public:
+	AFixedStepSimulation();
+
+	//Returns true if the game was started in fixed step mode
+	static bool IsFixedStepRequested();
+
+	// Called when the game starts or when spawned
+	virtual void BeginPlay() override;
+
+	// Called when the game ends or when destroyed
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	// Called every frame
+	virtual void Tick(float DeltaSeconds) override;
+
+	//Simulated seconds per wall-clock second since the mode started
+	float GetThroughput() const;
+
+	//Game and physics time advanced by every frame, in seconds
+	UPROPERTY(config)
+	float StepSeconds;
+
+	//Wall-clock seconds between two throughput reports, 0 only reports at the end
+	UPROPERTY(config)
+	float ReportInterval;
+
+private:
+	//Logs the throughput since the start and since the previous report
+	void Report();
+
+	//Writes the totals of the run to the file given with -FixedStepCsv=
+	void WriteCsv() const;
+
+	//Time simulated and wall-clock time spent since the mode started
+	double SimulatedSeconds;
+	double StartSeconds;
+	int32 NumFrames;
+
+	//Same at the previous report
+	double ReportSimulatedSeconds;
+	double ReportWallSeconds;
+
+	//Engine settings changed by the mode, given back when it ends
+	bool bSavedSmoothFrameRate;
+	float SavedMaxFPS;
+};
@@ -0,0 +1,98 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Kitchen.h"
+#include "FocusTraceScheduler.h"
+#include "InteractableRegistry.h"
+#include "KitchenWorldManager.h"
+#include "Async/ParallelFor.h"
+
+AFocusTraceScheduler::AFocusTraceScheduler()
+{
+	//Run after every character queued its trace for the frame
+	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.TickGroup = TG_PostPhysics;
+
+	ComplexTraceParams = FCollisionQueryParams(FName(TEXT("TraceComplex")), true);
+	ComplexTraceParams.bReturnPhysicalMaterial = false;
+
+	ResultsFrame = 0;
+	Registry = nullptr;
+	LastBatchCycles = 0;
+}
+
+AFocusTraceScheduler* AFocusTraceScheduler::Get(UWorld* World)
+{
+	return GetWorldManager<AFocusTraceScheduler>(World);
+}
+
+FFocusTraceTicket AFocusTraceScheduler::RequestTrace(const FVector& Start, const FVector& End, ECollisionChannel Channel, const FCollisionQueryParams& Params)
+{
+	FFocusTraceTicket Ticket;
+	Ticket.Frame = GFrameCounter;
+	Ticket.Index = Pending.AddDefaulted();
+
+	FFocusTraceRequest& Request = Pending[Ticket.Index];
+	Request.Start = Start;
+	Request.End = End;
+	Request.Channel = Channel;
+	Request.Params = Params;
+	return Ticket;
+}
+
+bool AFocusTraceScheduler::GetResult(const FFocusTraceTicket& Ticket, FHitResult& OutHit) const
+{
+	if (Ticket.Frame != ResultsFrame || !Results.IsValidIndex(Ticket.Index))
+	{
+		return false;
+	}
+	OutHit = Results[Ticket.Index];
+	return true;
+}
+
+void AFocusTraceScheduler::Tick(float DeltaSeconds)
+{
+	SCOPE_CYCLE_COUNTER(STAT_KitchenFocusBatch);
+	const uint32 BatchStartCycles = FPlatformTime::Cycles();
+
+	Super::Tick(DeltaSeconds);
+
+	if (!Registry)
+	{
+		Registry = AInteractableRegistry::Get(GetWorld());
+	}
+
+	const int32 NumRequests = Pending.Num();
+	Results.Reset();
+	Results.AddDefaulted(NumRequests);
+	ResultsFrame = GFrameCounter;
+	SET_DWORD_STAT(STAT_KitchenFocusBatchSize, NumRequests);
+
+	//The game thread takes part in the batch, so nothing modifies the scene or the registry meanwhile
+	UWorld* World = GetWorld();
+	const AInteractableRegistry* ConstRegistry = Registry;
+	const FCollisionQueryParams& ComplexParams = ComplexTraceParams;
+	const bool bRefine = CVarRefineFocusTrace.GetValueOnGameThread() != 0;
+	ParallelFor(NumRequests, [this, World, ConstRegistry, &ComplexParams, bRefine](int32 Index)
+	{
+		const FFocusTraceRequest& Request = Pending[Index];
+		FHitResult& Hit = Results[Index];
+
+		FHitResult SimpleHit(ForceInit);
+		World->LineTraceSingleByChannel(SimpleHit, Request.Start, Request.End, Request.Channel, Request.Params);
+
+		//Only interactables need the exact surface, everything else keeps the simple hit
+		UPrimitiveComponent* HitComponent = SimpleHit.GetComponent();
+		if (!bRefine || !SimpleHit.bBlockingHit || !HitComponent || !ConstRegistry || !ConstRegistry->Find(SimpleHit.GetActor()))
+		{
+			Hit = SimpleHit;
+		}
+		else if (!HitComponent->LineTraceComponent(Hit, Request.Start, Request.End, ComplexParams))
+		{
+			//The ray went through the simple collision but missed the actual mesh
+			Hit = FHitResult(ForceInit);
+		}
+	});
+
+	Pending.Reset();
+	LastBatchCycles = FPlatformTime::Cycles() - BatchStartCycles;
+}
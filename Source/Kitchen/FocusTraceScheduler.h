@@ -0,0 +1,76 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "GameFramework/Info.h"
+#include "FocusTraceScheduler.generated.h"
+
+class AInteractableRegistry;
+
+//Identifies a trace queued in the scheduler; the result can be read on the next frame
+struct FFocusTraceTicket
+{
+	uint64 Frame;
+	int32 Index;
+
+	FFocusTraceTicket()
+		: Frame(0)
+		, Index(INDEX_NONE)
+	{
+	}
+};
+
+/**
+ * Gathers the focus traces of all characters during the frame and runs them together,
+ * spread over the worker threads, once every character has ticked. Each character reads
+ * its result on the next frame, so no character ever waits for its own trace.
+ */
+UCLASS()
+class KITCHEN_API AFocusTraceScheduler : public AInfo
+{
+	GENERATED_BODY()
+
+public:
+	AFocusTraceScheduler();
+
+	//Returns the scheduler of the world, spawning it the first time it is requested
+	static AFocusTraceScheduler* Get(UWorld* World);
+
+	// Runs the traces queued during the frame
+	virtual void Tick(float DeltaSeconds) override;
+
+	//Queues a trace against simple collision; hits on interactables are refined against their triangles
+	FFocusTraceTicket RequestTrace(const FVector& Start, const FVector& End, ECollisionChannel Channel, const FCollisionQueryParams& Params);
+
+	//Reads the result of a trace queued on the previous frame; returns false if it is not available
+	bool GetResult(const FFocusTraceTicket& Ticket, FHitResult& OutHit) const;
+
+	//Time spent running the last batch, in cycles
+	uint32 GetLastBatchCycles() const { return LastBatchCycles; }
+
+private:
+	struct FFocusTraceRequest
+	{
+		FVector Start;
+		FVector End;
+		ECollisionChannel Channel;
+		FCollisionQueryParams Params;
+	};
+
+	//Traces queued during the current frame
+	TArray<FFocusTraceRequest> Pending;
+
+	//Results of the last batch, indexed like the requests
+	TArray<FHitResult> Results;
+
+	//Frame on which the requests of the last batch were queued
+	uint64 ResultsFrame;
+
+	//Parameters used for the refinement against complex collision
+	FCollisionQueryParams ComplexTraceParams;
+
+	UPROPERTY()
+	AInteractableRegistry* Registry;
+
+	uint32 LastBatchCycles;
+};
@@ -0,0 +1,125 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Kitchen.h"
+#include "GenerateCollisionProxiesCommandlet.h"
+#include "PhysicsEngine/BodySetup.h"
+#if WITH_EDITOR
+#include "AssetRegistryModule.h"
+#include "ConvexDecompTool.h"
+#endif
+
+UGenerateCollisionProxiesCommandlet::UGenerateCollisionProxiesCommandlet()
+{
+	IsClient = false;
+	IsEditor = true;
+	LogToConsole = true;
+
+	ConvexAccuracy = 0.5f;
+	MaxHullVertices = 16;
+}
+
+int32 UGenerateCollisionProxiesCommandlet::Main(const FString& Params)
+{
+#if WITH_EDITOR
+	FString Path = TEXT("/Game/Models/Tools");
+	FParse::Value(*Params, TEXT("Path="), Path);
+	const bool bBox = FParse::Param(*Params, TEXT("Box"));
+	const bool bForce = FParse::Param(*Params, TEXT("Force"));
+
+	IAssetRegistry& AssetRegistry = FModuleManager::LoadModuleChecked<FAssetRegistryModule>(TEXT("AssetRegistry")).Get();
+	AssetRegistry.SearchAllAssets(true);
+
+	FARFilter Filter;
+	Filter.PackagePaths.Add(FName(*Path));
+	Filter.ClassNames.Add(UStaticMesh::StaticClass()->GetFName());
+	Filter.bRecursivePaths = true;
+	TArray<FAssetData> Assets;
+	AssetRegistry.GetAssets(Filter, Assets);
+
+	int32 NumGenerated = 0;
+	for (const FAssetData& Asset : Assets)
+	{
+		UStaticMesh* Mesh = Cast<UStaticMesh>(Asset.GetAsset());
+		if (!Mesh || !Mesh->BodySetup)
+		{
+			continue;
+		}
+
+		//Meshes set up by hand are left alone
+		if (Mesh->BodySetup->AggGeom.GetElementCount() > 0 && !bForce)
+		{
+			UE_LOG(LogTemp, Display, TEXT("%s already has simple collision, skipped"), *Mesh->GetPathName());
+			continue;
+		}
+		if (!GenerateProxy(Mesh, bBox))
+		{
+			UE_LOG(LogTemp, Warning, TEXT("No collision could be generated for %s"), *Mesh->GetPathName());
+			continue;
+		}
+
+		UPackage* Package = Mesh->GetOutermost();
+		const FString FileName = FPackageName::LongPackageNameToFilename(Package->GetName(), FPackageName::GetAssetPackageExtension());
+		if (UPackage::SavePackage(Package, nullptr, RF_Standalone, *FileName))
+		{
+			NumGenerated++;
+			UE_LOG(LogTemp, Display, TEXT("%s: %d convex, %d box elements"), *Mesh->GetPathName(), Mesh->BodySetup->AggGeom.ConvexElems.Num(), Mesh->BodySetup->AggGeom.BoxElems.Num());
+		}
+		else
+		{
+			UE_LOG(LogTemp, Error, TEXT("Could not save %s"), *FileName);
+		}
+	}
+
+	UE_LOG(LogTemp, Display, TEXT("Collision proxies generated for %d of %d meshes under %s"), NumGenerated, Assets.Num(), *Path);
+	return 0;
+#else
+	UE_LOG(LogTemp, Error, TEXT("GenerateCollisionProxies needs the editor"));
+	return 1;
+#endif
+}
+
+bool UGenerateCollisionProxiesCommandlet::GenerateProxy(UStaticMesh* Mesh, bool bBox)
+{
+#if WITH_EDITOR
+	UBodySetup* BodySetup = Mesh->BodySetup;
+	BodySetup->Modify();
+	BodySetup->RemoveSimpleCollision();
+
+	if (bBox)
+	{
+		const FBox Bounds = Mesh->GetBoundingBox();
+		FKBoxElem Box(Bounds.GetSize().X, Bounds.GetSize().Y, Bounds.GetSize().Z);
+		Box.Center = Bounds.GetCenter();
+		BodySetup->AggGeom.BoxElems.Add(Box);
+	}
+	else
+	{
+		if (!Mesh->RenderData || Mesh->RenderData->LODResources.Num() == 0)
+		{
+			return false;
+		}
+
+		//Decompose the lowest detail of the scan, it keeps the shape with far fewer triangles
+		const FStaticMeshLODResources& LOD = Mesh->RenderData->LODResources.Last();
+		TArray<FVector> Vertices;
+		for (uint32 Index = 0; Index < LOD.PositionVertexBuffer.GetNumVertices(); Index++)
+		{
+			Vertices.Add(LOD.PositionVertexBuffer.VertexPosition(Index));
+		}
+		TArray<uint32> Indices;
+		LOD.IndexBuffer.GetCopy(Indices);
+
+		DecomposeMeshToHulls(BodySetup, Vertices, Indices, ConvexAccuracy, MaxHullVertices);
+	}
+
+	//Queries asking for complex collision get the proxy too
+	BodySetup->CollisionTraceFlag = CTF_UseSimpleAsComplex;
+	BodySetup->InvalidatePhysicsData();
+	BodySetup->CreatePhysicsMeshes();
+	Mesh->MarkPackageDirty();
+
+	return BodySetup->AggGeom.GetElementCount() > 0;
+#else
+	return false;
+#endif
+}
@@ -0,0 +1,31 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "Commandlets/Commandlet.h"
+#include "GenerateCollisionProxiesCommandlet.generated.h"
+
+/**
+ * Gives the scanned meshes simple collision and makes their complex queries use it, so tracing
+ * them no longer depends on the density of the scan. Run from the editor binary:
+ *   UE4Editor-Cmd.exe Kitchen.uproject -run=GenerateCollisionProxies [-Path=/Game/Models/Tools] [-Box] [-Force]
+ * -Box fits a single box instead of a convex decomposition, -Force replaces existing simple collision.
+ */
+UCLASS()
+class UGenerateCollisionProxiesCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UGenerateCollisionProxiesCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+
+private:
+	//Replaces the simple collision of a mesh; returns false if nothing could be generated
+	bool GenerateProxy(UStaticMesh* Mesh, bool bBox);
+
+	//Accuracy and hull size of the convex decomposition
+	float ConvexAccuracy;
+	int32 MaxHullVertices;
+};
@@ -0,0 +1,130 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Kitchen.h"
+#include "HandSlotComponent.h"
+#include "InteractableComponent.h"
+
+UHandSlotComponent::UHandSlotComponent()
+{
+	//Held items are placed after physics, and only while something is held
+	PrimaryComponentTick.bCanEverTick = true;
+	PrimaryComponentTick.bStartWithTickEnabled = false;
+	PrimaryComponentTick.TickGroup = TG_PostPhysics;
+
+	Side = 1.f;
+	YOffset = 20.f;
+	ZOffset = 30.f;
+	XOffset = 20.f;
+	HeldRotation = FRotator(0.f, 0.f, 0.f);
+
+	//Same limits the arrow keys always had
+	YOffsetRange = FVector2D(5.f, 25.f);
+	ZOffsetRange = FVector2D(20.f, 40.f);
+
+	HeldItem = nullptr;
+}
+
+void UHandSlotComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	UpdateHeldTransform();
+}
+
+void UHandSlotComponent::Hold(UInteractableComponent* Item)
+{
+	if (!Item || !Item->GetMesh())
+	{
+		return;
+	}
+	HeldItem = Item;
+	HeldItem->bHeld = true;
+
+	//Start from the grip of the item, keeping the rotation it had when picked unless the catalog gives one
+	XOffset = Item->GripOffset.X;
+	YOffset = Item->GripOffset.Y;
+	ZOffset = Item->GripOffset.Z;
+	HeldRotation = Item->bUseGripRotation ? Item->GripRotation : Item->GetOwner()->GetActorRotation();
+
+	//The item is carried kinematically, the solver no longer moves it
+	Item->GetMesh()->SetSimulatePhysics(false);
+
+	//Every machine moves it with the hand, the server stops sending its movement
+	Item->SetNetDormant(true);
+
+	LastLocation = FVector::ZeroVector;
+	LastRotation = FRotator::ZeroRotator;
+	UpdateHeldTransform();
+	SetComponentTickEnabled(true);
+}
+
+UInteractableComponent* UHandSlotComponent::Release()
+{
+	UInteractableComponent* Item = HeldItem;
+	HeldItem = nullptr;
+	SetComponentTickEnabled(false);
+
+	if (Item)
+	{
+		Item->bHeld = false;
+	}
+	if (Item && Item->GetMesh())
+	{
+		//Give the item back to physics
+		Item->GetMesh()->SetSimulatePhysics(true);
+	}
+	return Item;
+}
+
+void UHandSlotComponent::AdjustOffset(float DeltaY, float DeltaZ)
+{
+	//Moving to the right of the owner means further from it for the right hand, closer for the left one
+	YOffset = FMath::Clamp(YOffset + DeltaY * (Side < 0.f ? -1.f : 1.f), YOffsetRange.X, YOffsetRange.Y);
+	ZOffset = FMath::Clamp(ZOffset + DeltaZ, ZOffsetRange.X, ZOffsetRange.Y);
+}
+
+void UHandSlotComponent::UpdateHeldTransform()
+{
+	AActor* Owner = GetOwner();
+	if (!HeldItem || !Owner || !HeldItem->GetMesh())
+	{
+		return;
+	}
+
+	const FVector Location = Owner->GetActorLocation() + XOffset * Owner->GetActorForwardVector() + Side * YOffset * Owner->GetActorRightVector() + FVector(0.f, 0.f, ZOffset);
+	const FRotator Rotation = HeldRotation + FRotator(0.f, Owner->GetActorRotation().Yaw, 0.f);
+
+	//A single transform update, skipped when neither the owner nor the offsets moved
+	if (Location.Equals(LastLocation) && Rotation.Equals(LastRotation))
+	{
+		return;
+	}
+	HeldItem->GetMesh()->SetWorldLocationAndRotation(Location, Rotation);
+	HeldItem->NotifyMoved();
+	LastLocation = Location;
+	LastRotation = Rotation;
+}
+
+FQuantizedHeldPose UHandSlotComponent::GetQuantizedPose() const
+{
+	FQuantizedHeldPose Pose;
+	Pose.YOffset = static_cast<int16>(FMath::Clamp(FMath::RoundToInt(YOffset * 10.f), -MAX_int16, MAX_int16));
+	Pose.ZOffset = static_cast<int16>(FMath::Clamp(FMath::RoundToInt(ZOffset * 10.f), -MAX_int16, MAX_int16));
+	Pose.Pitch = FRotator::CompressAxisToShort(HeldRotation.Pitch);
+	Pose.Yaw = FRotator::CompressAxisToShort(HeldRotation.Yaw);
+	Pose.Roll = FRotator::CompressAxisToShort(HeldRotation.Roll);
+	return Pose;
+}
+
+void UHandSlotComponent::SetQuantizedPose(const FQuantizedHeldPose& Pose)
+{
+	//Not clamped, the grip of an item may start outside the adjustment limits
+	YOffset = Pose.YOffset * 0.1f;
+	ZOffset = Pose.ZOffset * 0.1f;
+	HeldRotation = FRotator(FRotator::DecompressAxisFromShort(Pose.Pitch), FRotator::DecompressAxisFromShort(Pose.Yaw), FRotator::DecompressAxisFromShort(Pose.Roll));
+}
+
+AActor* UHandSlotComponent::GetHeldActor() const
+{
+	return HeldItem ? HeldItem->GetOwner() : nullptr;
+}
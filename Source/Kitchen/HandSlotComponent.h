@@ -0,0 +1,123 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "Components/ActorComponent.h"
+#include "HandSlotComponent.generated.h"
+
+class UInteractableComponent;
+
+//Placement of a held item as sent over the network: offsets in millimeters, angles on 16 bits
+USTRUCT()
+struct FQuantizedHeldPose
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	int16 YOffset;
+
+	UPROPERTY()
+	int16 ZOffset;
+
+	UPROPERTY()
+	uint16 Pitch;
+
+	UPROPERTY()
+	uint16 Yaw;
+
+	UPROPERTY()
+	uint16 Roll;
+
+	FQuantizedHeldPose()
+		: YOffset(0)
+		, ZOffset(0)
+		, Pitch(0)
+		, Yaw(0)
+		, Roll(0)
+	{
+	}
+
+	bool operator==(const FQuantizedHeldPose& Other) const
+	{
+		return YOffset == Other.YOffset && ZOffset == Other.ZOffset && Pitch == Other.Pitch && Yaw == Other.Yaw && Roll == Other.Roll;
+	}
+
+	bool operator!=(const FQuantizedHeldPose& Other) const { return !(*this == Other); }
+};
+
+/**
+ * A hand (or any other holder, like a tray) which carries one item in front of its owner.
+ * The held item stops simulating while it is carried and is moved once per frame, after
+ * physics, so it never fights the solver.
+ */
+UCLASS(ClassGroup = (Kitchen), meta = (BlueprintSpawnableComponent))
+class KITCHEN_API UHandSlotComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	UHandSlotComponent();
+
+	// Called every frame while an item is held
+	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+	//Takes the item in this hand, keeping its current rotation
+	void Hold(UInteractableComponent* Item);
+
+	//Lets go of the held item and gives it back to physics; returns the item released
+	UInteractableComponent* Release();
+
+	//Moves the held item sideways and up/down, within the reach of the hand
+	void AdjustOffset(float DeltaY, float DeltaZ);
+
+	//Rotates the held item
+	void AddRotation(const FRotator& Increment) { HeldRotation += Increment; }
+
+	//Moves the held item to its place in front of the owner
+	void UpdateHeldTransform();
+
+	//Offsets and rotation of the held item, quantized for replication
+	FQuantizedHeldPose GetQuantizedPose() const;
+
+	//Places the held item with a replicated pose
+	void SetQuantizedPose(const FQuantizedHeldPose& Pose);
+
+	FORCEINLINE UInteractableComponent* GetHeldItem() const { return HeldItem; }
+	FORCEINLINE bool IsEmpty() const { return HeldItem == nullptr; }
+	AActor* GetHeldActor() const;
+
+	//Side of the owner this hand is on: 1 for right, -1 for left, 0 for centered holders
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Hand)
+	float Side;
+
+	//Sideways distance of the held item from the owner
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Hand)
+	float YOffset;
+
+	//Height of the held item above the owner
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Hand)
+	float ZOffset;
+
+	//Rotation of the held item, relative to the yaw of the owner
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Hand)
+	FRotator HeldRotation;
+
+	//Limits for the sideways and vertical adjustments
+	UPROPERTY(EditAnywhere, Category = Hand)
+	FVector2D YOffsetRange;
+
+	UPROPERTY(EditAnywhere, Category = Hand)
+	FVector2D ZOffsetRange;
+
+private:
+	//Item currently in this hand
+	UPROPERTY()
+	UInteractableComponent* HeldItem;
+
+	//Forward distance of the held item from the owner
+	float XOffset;
+
+	//Last transform applied, used to skip the update when nothing moved
+	FVector LastLocation;
+	FRotator LastRotation;
+};
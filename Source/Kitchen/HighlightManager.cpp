@@ -0,0 +1,113 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Kitchen.h"
+#include "HighlightManager.h"
+#include "KitchenWorldManager.h"
+
+AHighlightManager::AHighlightManager()
+{
+	//After every character and the benchmark had their say for the frame
+	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.TickGroup = TG_PostUpdateWork;
+
+	MaxUpdatesPerFrame = 16;
+	LastFrameUpdates = 0;
+}
+
+AHighlightManager* AHighlightManager::Get(UWorld* World)
+{
+	return GetWorldManager<AHighlightManager>(World);
+}
+
+void AHighlightManager::AddHighlight(UPrimitiveComponent* Component, EHighlightStyle Style)
+{
+	if (!Component)
+	{
+		return;
+	}
+
+	FHighlightState* State = Highlights.Find(Component);
+	if (!State)
+	{
+		State = &Highlights.Add(Component);
+		State->NumRequests = 0;
+		State->AppliedStyle = EHighlightStyle::None;
+	}
+	State->NumRequests++;
+	State->RequestedStyle = Style;
+	Dirty.AddUnique(Component);
+}
+
+void AHighlightManager::RemoveHighlight(UPrimitiveComponent* Component)
+{
+	FHighlightState* State = Component ? Highlights.Find(Component) : nullptr;
+	if (State && State->NumRequests > 0)
+	{
+		State->NumRequests--;
+		Dirty.AddUnique(Component);
+	}
+}
+
+void AHighlightManager::Tick(float DeltaSeconds)
+{
+	SCOPE_CYCLE_COUNTER(STAT_KitchenHighlight);
+
+	Super::Tick(DeltaSeconds);
+
+	int32 NumUpdates = 0;
+	int32 NumProcessed = 0;
+	for (; NumProcessed < Dirty.Num() && NumUpdates < MaxUpdatesPerFrame; NumProcessed++)
+	{
+		UPrimitiveComponent* Component = Dirty[NumProcessed].Get();
+		FHighlightState* State = Component ? Highlights.Find(Component) : nullptr;
+		if (!State)
+		{
+			continue;
+		}
+
+		//Only the net change of the frame reaches the renderer
+		const EHighlightStyle Style = State->NumRequests > 0 ? State->RequestedStyle : EHighlightStyle::None;
+		if (Style != State->AppliedStyle)
+		{
+			NumUpdates += Apply(Component, Style);
+			State->AppliedStyle = Style;
+		}
+		if (State->AppliedStyle == EHighlightStyle::None)
+		{
+			Highlights.Remove(Component);
+		}
+	}
+	Dirty.RemoveAt(0, NumProcessed, false);
+
+	//Meshes destroyed while highlighted
+	for (auto It = Highlights.CreateIterator(); It; ++It)
+	{
+		if (!It.Key().IsValid())
+		{
+			It.RemoveCurrent();
+		}
+	}
+
+	LastFrameUpdates = NumUpdates;
+	SET_DWORD_STAT(STAT_KitchenHighlightUpdates, NumUpdates);
+	SET_DWORD_STAT(STAT_KitchenHighlightedActors, Highlights.Num());
+}
+
+int32 AHighlightManager::Apply(UPrimitiveComponent* Component, EHighlightStyle Style) const
+{
+	int32 NumUpdates = 0;
+
+	//Each call dirties the render state, skip the ones which would not change anything
+	const bool bRender = Style != EHighlightStyle::None;
+	if (Component->bRenderCustomDepth != bRender)
+	{
+		Component->SetRenderCustomDepth(bRender);
+		NumUpdates++;
+	}
+	if (bRender && Component->CustomDepthStencilValue != static_cast<int32>(Style))
+	{
+		Component->SetCustomDepthStencilValue(static_cast<int32>(Style));
+		NumUpdates++;
+	}
+	return NumUpdates;
+}
@@ -0,0 +1,65 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "GameFramework/Info.h"
+#include "KitchenTypes.h"
+#include "HighlightManager.generated.h"
+
+/**
+ * Owns the custom depth outlines of the world. Highlights are requested and released during the
+ * frame and only the net changes are applied, once, at the end of the frame: a mesh focused and
+ * left within the same frame never touches its render state. The style is written to the custom
+ * stencil, so the outliner post-process draws every style in a single pass.
+ */
+UCLASS(config = Game)
+class KITCHEN_API AHighlightManager : public AInfo
+{
+	GENERATED_BODY()
+
+public:
+	AHighlightManager();
+
+	//Returns the highlight manager of the world, spawning it the first time it is requested
+	static AHighlightManager* Get(UWorld* World);
+
+	// Called at the end of every frame
+	virtual void Tick(float DeltaSeconds) override;
+
+	//Requests an outline around a mesh; each request must be released once
+	void AddHighlight(UPrimitiveComponent* Component, EHighlightStyle Style);
+
+	//Releases a request made with AddHighlight
+	void RemoveHighlight(UPrimitiveComponent* Component);
+
+	//Render state updates done at the end of the last frame
+	int32 GetLastFrameUpdates() const { return LastFrameUpdates; }
+
+	//Render state updates allowed per frame, the remaining ones wait for the next frames
+	UPROPERTY(config)
+	int32 MaxUpdatesPerFrame;
+
+private:
+	struct FHighlightState
+	{
+		//Number of requests still holding the outline
+		int32 NumRequests;
+
+		//Style requested last
+		EHighlightStyle RequestedStyle;
+
+		//Style currently rendered
+		EHighlightStyle AppliedStyle;
+	};
+
+	//Sets the render state of a mesh to a style; returns the number of render state updates done
+	int32 Apply(UPrimitiveComponent* Component, EHighlightStyle Style) const;
+
+	//All meshes highlighted or waiting for a change
+	TMap<TWeakObjectPtr<UPrimitiveComponent>, FHighlightState> Highlights;
+
+	//Meshes changed since the last update, each listed once
+	TArray<TWeakObjectPtr<UPrimitiveComponent>> Dirty;
+
+	int32 LastFrameUpdates;
+};
@@ -0,0 +1,177 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Kitchen.h"
+#include "InteractableComponent.h"
+#include "InteractableRegistry.h"
+#include "PhysicsEngine/PhysicsConstraintComponent.h"
+#include "UnrealNetwork.h"
+
+UInteractableComponent::UInteractableComponent()
+{
+	//Nothing to update every frame, the component only holds data
+	PrimaryComponentTick.bCanEverTick = false;
+	bWantsBeginPlay = true;
+
+	Kind = EInteractableKind::Item;
+	ItemType = EItemType::GeneralItem;
+	AssetState = EAssetState::Closed;
+	bHeld = false;
+
+	//Default offsets used for every item held in hand
+	GripOffset = FVector(20.f, 20.f, 30.f);
+	GripRotation = FRotator(0.f, 0.f, 0.f);
+	bUseGripRotation = false;
+	LocalBounds = FBox(FVector::ZeroVector, FVector::ZeroVector);
+
+	Mesh = nullptr;
+	OpenTarget = nullptr;
+	Drive = nullptr;
+	Registry = nullptr;
+}
+
+void UInteractableComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	Registry = AInteractableRegistry::Get(GetWorld());
+	if (Registry)
+	{
+		Registry->Register(this);
+	}
+}
+
+void UInteractableComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	//Do not spawn a registry while the world is being torn down
+	AInteractableRegistry* CurrentRegistry = AInteractableRegistry::FindInWorld(GetWorld());
+	if (CurrentRegistry)
+	{
+		CurrentRegistry->Unregister(this);
+	}
+	Registry = nullptr;
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void UInteractableComponent::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	DOREPLIFETIME(UInteractableComponent, AssetState);
+}
+
+void UInteractableComponent::CacheMesh()
+{
+	SCOPE_CYCLE_COUNTER(STAT_KitchenResolveMesh);
+
+	AActor* Owner = GetOwner();
+	if (!Owner)
+	{
+		return;
+	}
+
+	//Most interactables are static mesh actors, where the mesh is the root
+	Mesh = Cast<UStaticMeshComponent>(Owner->GetRootComponent());
+	if (!Mesh)
+	{
+		Mesh = Owner->FindComponentByClass<UStaticMeshComponent>();
+	}
+
+	//Items outside the catalog keep the bounds of their mesh
+	if (Mesh)
+	{
+		FVector Min, Max;
+		Mesh->GetLocalBounds(Min, Max);
+		LocalBounds = FBox(Min, Max);
+	}
+}
+
+void UInteractableComponent::NotifyMoved()
+{
+	if (Registry)
+	{
+		Registry->UpdateLocation(this);
+	}
+}
+
+void UInteractableComponent::EnableWakeEvents(UPhysicsConstraintComponent* Constraint)
+{
+	if (!Mesh || Mesh->BodyInstance.bGenerateWakeEvents)
+	{
+		return;
+	}
+	Mesh->BodyInstance.bGenerateWakeEvents = true;
+
+	//The flag is only read when the body is created, and the bodies placed in the level already are
+	if (!Mesh->IsPhysicsStateCreated())
+	{
+		return;
+	}
+	const bool bAwake = Mesh->RigidBodyIsAwake();
+	const FVector LinearVelocity = Mesh->GetPhysicsLinearVelocity();
+	const FVector AngularVelocity = Mesh->GetPhysicsAngularVelocity();
+
+	//The joint refers to the body, it is created again with it
+	if (Constraint)
+	{
+		Constraint->TermComponentConstraint();
+	}
+	Mesh->RecreatePhysicsState();
+	if (Constraint)
+	{
+		Constraint->InitComponentConstraint();
+	}
+
+	//The new body starts awake and still
+	if (!Mesh->IsSimulatingPhysics())
+	{
+		return;
+	}
+	if (bAwake)
+	{
+		Mesh->SetPhysicsLinearVelocity(LinearVelocity);
+		Mesh->SetPhysicsAngularVelocity(AngularVelocity);
+	}
+	else
+	{
+		Mesh->PutRigidBodyToSleep();
+	}
+}
+
+void UInteractableComponent::SetNetDormant(bool bDormant)
+{
+	AActor* Owner = GetOwner();
+	if (Owner && Owner->GetIsReplicated() && Owner->Role == ROLE_Authority)
+	{
+		Owner->SetNetDormancy(bDormant ? DORM_DormantAll : DORM_Awake);
+	}
+}
+
+void UInteractableComponent::FlushNetState()
+{
+	AActor* Owner = GetOwner();
+	if (Owner && Owner->GetIsReplicated() && Owner->Role == ROLE_Authority)
+	{
+		Owner->FlushNetDormancy();
+	}
+}
+
+void UInteractableComponent::ApplyItemInfo(const FKitchenItemInfo& Info)
+{
+	ItemType = Info.Row.ItemType;
+	GripOffset = Info.Row.GripOffset;
+	GripRotation = Info.Row.GripRotation;
+	bUseGripRotation = Info.Row.bUseGripRotation;
+	LocalBounds = Info.LocalBounds;
+
+	if (Mesh && Info.Row.Mass > 0.f)
+	{
+		FBodyInstance* Body = Mesh->GetBodyInstance();
+		if (Body)
+		{
+			Body->bOverrideMass = true;
+			Body->MassInKg = Info.Row.Mass;
+			Body->UpdateMassProperties();
+		}
+	}
+}
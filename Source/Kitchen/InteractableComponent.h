@@ -0,0 +1,126 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "Components/ActorComponent.h"
+#include "KitchenTypes.h"
+#include "InteractableComponent.generated.h"
+
+class UOpenableDriveComponent;
+class UPhysicsConstraintComponent;
+class AInteractableRegistry;
+
+//Kind of interaction supported by the owner of an interactable component
+UENUM(BlueprintType)
+enum class EInteractableKind : uint8
+{
+	Item UMETA(DisplayName = "Item"),
+	Openable UMETA(DisplayName = "Openable"),
+	Handle UMETA(DisplayName = "Handle")
+};
+
+/**
+ * Marks an actor as something the character can interact with and caches everything the
+ * interaction code needs (mesh, item type, grip offsets, open/closed state), so the hot paths
+ * only follow pointers instead of searching the components of the actor.
+ */
+UCLASS(ClassGroup = (Kitchen), meta = (BlueprintSpawnableComponent))
+class KITCHEN_API UInteractableComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	UInteractableComponent();
+
+	// Called when the game starts or when spawned
+	virtual void BeginPlay() override;
+
+	// Called when the game ends or when destroyed
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	//The open/closed state of drawers and doors is decided by the server and replicated
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
+	//Resolves and caches the mesh of the owner and its bounds; called once when the component is registered
+	void CacheMesh();
+
+	//Copies the values of the item catalog entry of the mesh
+	void ApplyItemInfo(const FKitchenItemInfo& Info);
+
+	//Tells the registry the owner moved, so its spatial queries see the new location
+	void NotifyMoved();
+
+	//Makes the mesh send its wake and sleep events; the body is created again if it exists, with the constraint holding it
+	void EnableWakeEvents(UPhysicsConstraintComponent* Constraint = nullptr);
+
+	//On a server, lets the owner replicate while it moves and stops it once it rests
+	void SetNetDormant(bool bDormant);
+
+	//On a server, sends the current state of a dormant owner once; used after teleports
+	void FlushNetState();
+
+	//Returns the static mesh cached at registration
+	FORCEINLINE UStaticMeshComponent* GetMesh() const { return Mesh; }
+
+	//Returns the component which receives the open/close action; for handles this is the drawer or door they are attached to
+	FORCEINLINE UInteractableComponent* GetOpenTarget() const { return Kind == EInteractableKind::Handle ? OpenTarget : const_cast<UInteractableComponent*>(this); }
+
+	//Links a handle to the drawer or door it opens
+	void SetOpenTarget(UInteractableComponent* Target) { OpenTarget = Target; }
+
+	//Returns the drive opening and closing this drawer or door, nullptr for items and handles
+	FORCEINLINE UOpenableDriveComponent* GetDrive() const { return Drive; }
+	void SetDrive(UOpenableDriveComponent* InDrive) { Drive = InDrive; }
+
+	FORCEINLINE bool IsItem() const { return Kind == EInteractableKind::Item; }
+	FORCEINLINE bool IsOpenable() const { return GetOpenTarget() != nullptr && !IsItem(); }
+
+	//What the character can do with the owner
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Interaction)
+	EInteractableKind Kind;
+
+	//Type of the item, only used for items
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Interaction)
+	EItemType ItemType;
+
+	//Position of the item relative to the hand holding it: X forward, Y to the side, Z up
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Interaction)
+	FVector GripOffset;
+
+	//Rotation of the item in hand, relative to the view of the character
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Interaction)
+	FRotator GripRotation;
+
+	//If false the item keeps the rotation it had when it was picked
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Interaction)
+	bool bUseGripRotation;
+
+	//Local bounds of the mesh, used to place the item when it is dropped
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Interaction)
+	FBox LocalBounds;
+
+	//Open/closed state, only used for drawers and doors; measured by the server, which replicates it
+	UPROPERTY(Replicated, EditAnywhere, BlueprintReadOnly, Category = Interaction)
+	EAssetState AssetState;
+
+	//True while the item is in the hand of a character
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Interaction)
+	bool bHeld;
+
+private:
+	//Mesh of the owner, resolved once
+	UPROPERTY()
+	UStaticMeshComponent* Mesh;
+
+	//Registry the component registered with
+	UPROPERTY()
+	AInteractableRegistry* Registry;
+
+	//Drawer or door opened by this handle
+	UPROPERTY()
+	UInteractableComponent* OpenTarget;
+
+	//Motor of the drawer or door
+	UPROPERTY()
+	UOpenableDriveComponent* Drive;
+};
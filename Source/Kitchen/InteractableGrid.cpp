@@ -0,0 +1,253 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Kitchen.h"
+#include "InteractableGrid.h"
+#include "InteractableComponent.h"
+
+FInteractableGrid::FInteractableGrid(float InCellSize)
+	: CellSize(FMath::Max(InCellSize, 1.f))
+{
+}
+
+FIntPoint FInteractableGrid::GetCell(const FVector& Location) const
+{
+	return FIntPoint(FMath::FloorToInt(Location.X / CellSize), FMath::FloorToInt(Location.Y / CellSize));
+}
+
+void FInteractableGrid::Update(UInteractableComponent* Interactable, const FVector& Location)
+{
+	const FIntPoint Cell = GetCell(Location);
+	FIntPoint* OldCell = EntryCells.Find(Interactable);
+
+	//Still in the same column, only the location changes
+	if (OldCell && *OldCell == Cell)
+	{
+		for (FEntry& Entry : Cells.FindChecked(Cell))
+		{
+			if (Entry.Interactable == Interactable)
+			{
+				Entry.Location = Location;
+				return;
+			}
+		}
+	}
+
+	if (OldCell)
+	{
+		Remove(Interactable);
+	}
+	TArray<FEntry>& Entries = Cells.FindOrAdd(Cell);
+	FEntry& Entry = Entries[Entries.AddUninitialized()];
+	Entry.Interactable = Interactable;
+	Entry.Location = Location;
+	EntryCells.Add(Interactable, Cell);
+}
+
+void FInteractableGrid::Remove(UInteractableComponent* Interactable)
+{
+	FIntPoint Cell;
+	if (!EntryCells.RemoveAndCopyValue(Interactable, Cell))
+	{
+		return;
+	}
+
+	TArray<FEntry>& Entries = Cells.FindChecked(Cell);
+	for (int32 Index = 0; Index < Entries.Num(); Index++)
+	{
+		if (Entries[Index].Interactable == Interactable)
+		{
+			Entries.RemoveAtSwap(Index);
+			break;
+		}
+	}
+	if (Entries.Num() == 0)
+	{
+		Cells.Remove(Cell);
+	}
+}
+
+void FInteractableGrid::Reset()
+{
+	Cells.Reset();
+	EntryCells.Reset();
+}
+
+template<typename TVisitor>
+void FInteractableGrid::ForEachInRadius(const FVector& Origin, float Radius, TVisitor Visitor) const
+{
+	const FIntPoint MinCell = GetCell(Origin - FVector(Radius));
+	const FIntPoint MaxCell = GetCell(Origin + FVector(Radius));
+	const float RadiusSquared = FMath::Square(Radius);
+
+	for (int32 X = MinCell.X; X <= MaxCell.X; X++)
+	{
+		for (int32 Y = MinCell.Y; Y <= MaxCell.Y; Y++)
+		{
+			const TArray<FEntry>* Entries = Cells.Find(FIntPoint(X, Y));
+			if (!Entries)
+			{
+				continue;
+			}
+			for (const FEntry& Entry : *Entries)
+			{
+				const float DistanceSquared = FVector::DistSquared(Origin, Entry.Location);
+				if (DistanceSquared <= RadiusSquared)
+				{
+					Visitor(Entry, DistanceSquared);
+				}
+			}
+		}
+	}
+}
+
+static void SortByDistance(TArray<FInteractableQueryResult>& Results)
+{
+	Results.Sort([](const FInteractableQueryResult& A, const FInteractableQueryResult& B)
+	{
+		return A.Distance < B.Distance;
+	});
+}
+
+void FInteractableGrid::FindInRadius(const FVector& Origin, float Radius, TArray<FInteractableQueryResult>& OutResults) const
+{
+	OutResults.Reset();
+	ForEachInRadius(Origin, Radius, [&OutResults](const FEntry& Entry, float DistanceSquared)
+	{
+		OutResults.Emplace(Entry.Interactable, FMath::Sqrt(DistanceSquared));
+	});
+	SortByDistance(OutResults);
+}
+
+void FInteractableGrid::FindInCone(const FVector& Origin, const FVector& Direction, float HalfAngleDegrees, float Radius, TArray<FInteractableQueryResult>& OutResults) const
+{
+	OutResults.Reset();
+	const float CosHalfAngle = FMath::Cos(FMath::DegreesToRadians(HalfAngleDegrees));
+	ForEachInRadius(Origin, Radius, [&OutResults, &Origin, &Direction, CosHalfAngle](const FEntry& Entry, float DistanceSquared)
+	{
+		//Compare the projection with the distance scaled by the cosine, no square root for the rejected ones
+		const float Projection = FVector::DotProduct(Entry.Location - Origin, Direction);
+		if (Projection >= 0.f && FMath::Square(Projection) >= FMath::Square(CosHalfAngle) * DistanceSquared)
+		{
+			OutResults.Emplace(Entry.Interactable, FMath::Sqrt(DistanceSquared));
+		}
+	});
+	SortByDistance(OutResults);
+}
+
+//Compares the grid with a scan of every interactable for the kitchen reach, on synthetic scenes of growing size
+static void BenchmarkInteractableGrid(const TArray<FString>& Args)
+{
+	const int32 NumQueries = Args.Num() > 0 ? FCString::Atoi(*Args[0]) : 1000;
+	const float Radius = 150.f;
+	const float HalfAngle = 30.f;
+	const int32 Sizes[] = { 100, 1000, 10000 };
+
+	UE_LOG(LogTemp, Log, TEXT("Items,Queries,Grid Radius (us),Linear Radius (us),Grid Cone (us),Linear Cone (us),Hits per Query,Mismatches"));
+	for (const int32 NumItems : Sizes)
+	{
+		//Same density as the kitchen, about one item per square meter of counter, spread over a square
+		FRandomStream Random(NumItems);
+		const float Extent = 50.f * FMath::Sqrt(static_cast<float>(NumItems));
+
+		TArray<UInteractableComponent*> Items;
+		TArray<FVector> Locations;
+		FInteractableGrid Grid;
+		for (int32 Index = 0; Index < NumItems; Index++)
+		{
+			Items.Add(NewObject<UInteractableComponent>(GetTransientPackage()));
+			Locations.Add(FVector(Random.FRandRange(-Extent, Extent), Random.FRandRange(-Extent, Extent), Random.FRandRange(0.f, 200.f)));
+			Grid.Update(Items[Index], Locations[Index]);
+		}
+
+		TArray<FVector> Origins;
+		TArray<FVector> Directions;
+		for (int32 Query = 0; Query < NumQueries; Query++)
+		{
+			Origins.Add(FVector(Random.FRandRange(-Extent, Extent), Random.FRandRange(-Extent, Extent), 150.f));
+			Directions.Add(Random.GetUnitVector());
+		}
+
+		TArray<FInteractableQueryResult> Results;
+		TArray<FInteractableQueryResult> LinearResults;
+		int32 NumHits = 0;
+		int32 NumMismatches = 0;
+
+		double StartSeconds = FPlatformTime::Seconds();
+		for (int32 Query = 0; Query < NumQueries; Query++)
+		{
+			Grid.FindInRadius(Origins[Query], Radius, Results);
+			NumHits += Results.Num();
+		}
+		const double GridRadiusSeconds = FPlatformTime::Seconds() - StartSeconds;
+
+		//The scan every caller had to write without the grid
+		StartSeconds = FPlatformTime::Seconds();
+		for (int32 Query = 0; Query < NumQueries; Query++)
+		{
+			LinearResults.Reset();
+			for (int32 Index = 0; Index < NumItems; Index++)
+			{
+				const float Distance = FVector::Dist(Origins[Query], Locations[Index]);
+				if (Distance <= Radius)
+				{
+					LinearResults.Emplace(Items[Index], Distance);
+				}
+			}
+			SortByDistance(LinearResults);
+		}
+		const double LinearRadiusSeconds = FPlatformTime::Seconds() - StartSeconds;
+
+		StartSeconds = FPlatformTime::Seconds();
+		for (int32 Query = 0; Query < NumQueries; Query++)
+		{
+			Grid.FindInCone(Origins[Query], Directions[Query], HalfAngle, Radius, Results);
+		}
+		const double GridConeSeconds = FPlatformTime::Seconds() - StartSeconds;
+
+		const float CosHalfAngle = FMath::Cos(FMath::DegreesToRadians(HalfAngle));
+		StartSeconds = FPlatformTime::Seconds();
+		for (int32 Query = 0; Query < NumQueries; Query++)
+		{
+			LinearResults.Reset();
+			for (int32 Index = 0; Index < NumItems; Index++)
+			{
+				const FVector Offset = Locations[Index] - Origins[Query];
+				const float Distance = Offset.Size();
+				if (Distance <= Radius && FVector::DotProduct(Offset, Directions[Query]) >= CosHalfAngle * Distance)
+				{
+					LinearResults.Emplace(Items[Index], Distance);
+				}
+			}
+			SortByDistance(LinearResults);
+		}
+		const double LinearConeSeconds = FPlatformTime::Seconds() - StartSeconds;
+
+		//Both give the same candidates
+		for (int32 Query = 0; Query < FMath::Min(NumQueries, 100); Query++)
+		{
+			Grid.FindInRadius(Origins[Query], Radius, Results);
+			int32 NumLinear = 0;
+			for (const FVector& Location : Locations)
+			{
+				NumLinear += FVector::Dist(Origins[Query], Location) <= Radius ? 1 : 0;
+			}
+			NumMismatches += Results.Num() != NumLinear ? 1 : 0;
+		}
+
+		const double ToMicroseconds = 1000000.0 / FMath::Max(NumQueries, 1);
+		UE_LOG(LogTemp, Log, TEXT("%d,%d,%.2f,%.2f,%.2f,%.2f,%.1f,%d"), NumItems, NumQueries,
+			GridRadiusSeconds * ToMicroseconds, LinearRadiusSeconds * ToMicroseconds,
+			GridConeSeconds * ToMicroseconds, LinearConeSeconds * ToMicroseconds,
+			static_cast<float>(NumHits) / FMath::Max(NumQueries, 1), NumMismatches);
+
+		for (UInteractableComponent* Item : Items)
+		{
+			Item->MarkPendingKill();
+		}
+	}
+}
+
+static FAutoConsoleCommand BenchmarkInteractableGridCommand(
+	TEXT("Kitchen.BenchmarkSpatialIndex"),
+	TEXT("Times radius and cone queries of the interactable grid against a linear scan for 100, 1k and 10k items. Optional argument: number of queries"),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&BenchmarkInteractableGrid));
@@ -0,0 +1,68 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+class UInteractableComponent;
+
+//Interactable found by a spatial query, with its distance to the query origin
+struct FInteractableQueryResult
+{
+	UInteractableComponent* Interactable;
+	float Distance;
+
+	FInteractableQueryResult(UInteractableComponent* InInteractable, float InDistance)
+		: Interactable(InInteractable)
+		, Distance(InDistance)
+	{
+	}
+};
+
+/**
+ * Uniform grid over the interactables, answering "what is around this point" without looking
+ * at every interactable. The kitchen is flat, so the grid is made of vertical columns and only
+ * the horizontal position picks the column; distances are measured in 3D. An interactable only
+ * changes column when it moves across a cell border, so moving items cost a lookup per update.
+ * Interactables must be removed before they are destroyed, the grid does not check them.
+ */
+struct KITCHEN_API FInteractableGrid
+{
+	FInteractableGrid(float InCellSize = 50.f);
+
+	//Adds an interactable, or moves it if it is already in the grid
+	void Update(UInteractableComponent* Interactable, const FVector& Location);
+
+	//Removes an interactable, does nothing if it is not in the grid
+	void Remove(UInteractableComponent* Interactable);
+
+	//Removes everything
+	void Reset();
+
+	int32 Num() const { return EntryCells.Num(); }
+
+	//Fills OutResults with the interactables closer than Radius to Origin, sorted by distance
+	void FindInRadius(const FVector& Origin, float Radius, TArray<FInteractableQueryResult>& OutResults) const;
+
+	//Fills OutResults with the interactables closer than Radius inside the cone around Direction (normalized), sorted by distance
+	void FindInCone(const FVector& Origin, const FVector& Direction, float HalfAngleDegrees, float Radius, TArray<FInteractableQueryResult>& OutResults) const;
+
+private:
+	struct FEntry
+	{
+		UInteractableComponent* Interactable;
+		FVector Location;
+	};
+
+	FIntPoint GetCell(const FVector& Location) const;
+
+	//Visits the entries of the columns overlapping the circle of Radius around Origin
+	template<typename TVisitor>
+	void ForEachInRadius(const FVector& Origin, float Radius, TVisitor Visitor) const;
+
+	float CellSize;
+
+	//Entries of each non-empty column
+	TMap<FIntPoint, TArray<FEntry>> Cells;
+
+	//Column of each interactable in the grid
+	TMap<const UInteractableComponent*, FIntPoint> EntryCells;
+};
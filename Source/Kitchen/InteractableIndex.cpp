@@ -0,0 +1,59 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Kitchen.h"
+#include "InteractableIndex.h"
+#include "PhysicsEngine/PhysicsConstraintComponent.h"
+
+FString UInteractableIndex::GetIndexPackageName(const FString& LevelPackageName)
+{
+	return UWorld::RemovePIEPrefix(LevelPackageName) + TEXT("_Interactables");
+}
+
+UInteractableIndex* UInteractableIndex::LoadForLevel(const ULevel* Level)
+{
+	return LoadForPackage(Level->GetOutermost()->GetName());
+}
+
+UInteractableIndex* UInteractableIndex::LoadForPackage(const FString& LevelPackageName)
+{
+	const FString PackageName = GetIndexPackageName(LevelPackageName);
+	const FString ObjectPath = PackageName + TEXT(".") + FPackageName::GetShortName(PackageName);
+
+	//Loaded by an earlier visit of the level, or once from disk; a level without index is not an error
+	UInteractableIndex* Index = FindObject<UInteractableIndex>(nullptr, *ObjectPath);
+	if (!Index && FPackageName::DoesPackageExist(PackageName))
+	{
+		Index = LoadObject<UInteractableIndex>(nullptr, *ObjectPath, nullptr, LOAD_NoWarn | LOAD_Quiet);
+	}
+	return Index;
+}
+
+bool UInteractableIndex::ClassifyActor(const AActor* Actor, EInteractableKind& OutKind)
+{
+	//Handles are named as such and attached to the drawer or door they open, which is registered with them
+	if (Actor->GetName().Contains(TEXT("Handle")))
+	{
+		if (Actor->GetAttachParentActor() != nullptr && Actor->FindComponentByClass<UStaticMeshComponent>() != nullptr)
+		{
+			OutKind = EInteractableKind::Handle;
+			return true;
+		}
+	}
+	//Items are tagged when they are placed, the index build reports the catalog meshes which are not
+	else if (Actor->ActorHasTag(FName(TEXT("Item"))))
+	{
+		OutKind = EInteractableKind::Item;
+		return true;
+	}
+	return false;
+}
+
+bool UInteractableIndex::IsCandidate(const AActor* Actor)
+{
+	return Actor->ActorHasTag(FName(TEXT("Item"))) || Actor->GetName().Contains(TEXT("Handle")) || Actor->FindComponentByClass<UPhysicsConstraintComponent>() != nullptr;
+}
+
+bool UInteractableIndex::HasSameContent(const UInteractableIndex* Other) const
+{
+	return Other && Entries == Other->Entries && ConstraintActors == Other->ConstraintActors && CandidateActors == Other->CandidateActors;
+}
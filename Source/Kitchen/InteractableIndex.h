@@ -0,0 +1,77 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "Engine/DataAsset.h"
+#include "InteractableComponent.h"
+#include "InteractableIndex.generated.h"
+
+//Actor of a level classified as interactive
+USTRUCT()
+struct FInteractableIndexEntry
+{
+	GENERATED_BODY()
+
+	//Name of the actor in its level
+	UPROPERTY(VisibleAnywhere, Category = Index)
+	FName ActorName;
+
+	UPROPERTY(VisibleAnywhere, Category = Index)
+	EInteractableKind Kind;
+
+	FInteractableIndexEntry()
+		: Kind(EInteractableKind::Item)
+	{
+	}
+
+	bool operator==(const FInteractableIndexEntry& Other) const
+	{
+		return ActorName == Other.ActorName && Kind == Other.Kind;
+	}
+};
+
+/**
+ * Interactive actors of one level, classified and validated by the BuildInteractableIndex
+ * commandlet when the levels are built. The registry registers the actors listed here instead of
+ * classifying the actors of the level, and only does so for levels which have no index or an index
+ * listing actors the level no longer has. An index missing a new actor is found by the -Check run
+ * of the commandlet before cooking, which compares the names of every actor the rules look at;
+ * the runtime only looks up the listed names.
+ * The index of /Game/Levels/X/X is /Game/Levels/X/X_Interactables.
+ */
+UCLASS()
+class KITCHEN_API UInteractableIndex : public UDataAsset
+{
+	GENERATED_BODY()
+
+public:
+	//Package of the index of a level package, which may have an editor prefix
+	static FString GetIndexPackageName(const FString& LevelPackageName);
+
+	//Loads the index of a level; returns null if the level has none
+	static UInteractableIndex* LoadForLevel(const ULevel* Level);
+
+	//Loads the index of a level package, which may have an editor prefix; returns null if there is none
+	static UInteractableIndex* LoadForPackage(const FString& LevelPackageName);
+
+	//Kind of interactable an actor placed without an interactable component is, by its name and tags; returns false if it is not one
+	static bool ClassifyActor(const AActor* Actor, EInteractableKind& OutKind);
+
+	//True for the actors the rules look at: named as a handle, tagged as an item or holding a constraint
+	static bool IsCandidate(const AActor* Actor);
+
+	//True if both indexes list the same actors
+	bool HasSameContent(const UInteractableIndex* Other) const;
+
+	//Handles, drawers, doors and items without an interactable component of their own
+	UPROPERTY(VisibleAnywhere, Category = Index)
+	TArray<FInteractableIndexEntry> Entries;
+
+	//Actors owning the physics constraints which hold the drawers and doors
+	UPROPERTY(VisibleAnywhere, Category = Index)
+	TArray<FName> ConstraintActors;
+
+	//Fingerprint of the level compared by -Check: the sorted names of its candidate actors, including the rejected ones
+	UPROPERTY(VisibleAnywhere, Category = Index)
+	TArray<FName> CandidateActors;
+};
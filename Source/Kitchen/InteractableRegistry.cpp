@@ -0,0 +1,529 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Kitchen.h"
+#include "InteractableRegistry.h"
+#include "InteractableComponent.h"
+#include "InteractableIndex.h"
+#include "ItemCatalog.h"
+#include "OpenableDriveComponent.h"
+#include "SettleManager.h"
+#include "PhysicsEngine/PhysicsConstraintComponent.h"
+#include "EngineUtils.h"
+
+AInteractableRegistry::AInteractableRegistry()
+{
+#if STATS
+	//The registry only ticks to count the awake bodies
+	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.TickGroup = TG_PostPhysics;
+#else
+	//The registry only reacts to world events
+	PrimaryActorTick.bCanEverTick = false;
+#endif
+
+	Catalog = nullptr;
+	NetCullDistance = 1500.f;
+	NetUpdateFrequency = 20.f;
+}
+
+AInteractableRegistry* AInteractableRegistry::FindInWorld(UWorld* World)
+{
+	if (!World)
+	{
+		return nullptr;
+	}
+
+	//The iterator only visits actors of our class, not the whole level
+	for (TActorIterator<AInteractableRegistry> It(World); It; ++It)
+	{
+		return *It;
+	}
+	return nullptr;
+}
+
+AInteractableRegistry* AInteractableRegistry::Get(UWorld* World)
+{
+	AInteractableRegistry* Registry = FindInWorld(World);
+	if (Registry || !World)
+	{
+		return Registry;
+	}
+
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.Name = TEXT("InteractableRegistry");
+	Registry = World->SpawnActor<AInteractableRegistry>(SpawnParams);
+	if (Registry)
+	{
+		Registry->Initialize();
+	}
+	return Registry;
+}
+
+void AInteractableRegistry::Initialize()
+{
+	UWorld* World = GetWorld();
+
+	LevelAddedHandle = FWorldDelegates::LevelAddedToWorld.AddUObject(this, &AInteractableRegistry::OnLevelAdded);
+	LevelRemovedHandle = FWorldDelegates::LevelRemovedFromWorld.AddUObject(this, &AInteractableRegistry::OnLevelRemoved);
+	ActorSpawnedHandle = World->AddOnActorSpawnedHandler(FOnActorSpawned::FDelegate::CreateUObject(this, &AInteractableRegistry::OnActorSpawned));
+
+	//Start loading the item catalog, items registered before it is ready are updated when it finishes
+	Catalog = AItemCatalog::Get(World);
+
+	//Levels loaded before the registry was created
+	for (ULevel* Level : World->GetLevels())
+	{
+		if (Level && Level->bIsVisible)
+		{
+			RegisterLevel(Level);
+		}
+	}
+}
+
+void AInteractableRegistry::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	FWorldDelegates::LevelAddedToWorld.Remove(LevelAddedHandle);
+	FWorldDelegates::LevelRemovedFromWorld.Remove(LevelRemovedHandle);
+	if (GetWorld())
+	{
+		GetWorld()->RemoveOnActorSpawnedHandler(ActorSpawnedHandle);
+	}
+
+	Interactables.Empty();
+	SpatialIndex.Reset();
+	SET_DWORD_STAT(STAT_KitchenRegisteredInteractables, 0);
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void AInteractableRegistry::Tick(float DeltaSeconds)
+{
+	Super::Tick(DeltaSeconds);
+
+#if STATS
+	int32 NumAwake = 0;
+	for (const auto& Entry : Interactables)
+	{
+		UInteractableComponent* Interactable = Entry.Value.Get();
+		if (Interactable && Interactable->GetMesh() && Interactable->GetMesh()->IsSimulatingPhysics() && Interactable->GetMesh()->RigidBodyIsAwake())
+		{
+			NumAwake++;
+		}
+	}
+	SET_DWORD_STAT(STAT_KitchenAwakeBodies, NumAwake);
+#endif
+}
+
+void AInteractableRegistry::RegisterLevel(ULevel* Level)
+{
+	const UInteractableIndex* Index = UInteractableIndex::LoadForLevel(Level);
+	if (Index && RegisterIndexedLevel(Level, Index))
+	{
+		return;
+	}
+	if (Index)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("The interactable index of %s lists actors the level no longer has, the level is scanned; run the BuildInteractableIndex commandlet"), *Level->GetOutermost()->GetName());
+	}
+
+	//Constraints first, drawers may come before the constraint holding them
+	for (AActor* Actor : Level->Actors)
+	{
+		if (Actor && !Actor->IsPendingKill())
+		{
+			AddConstraints(Actor);
+		}
+	}
+
+	for (AActor* Actor : Level->Actors)
+	{
+		if (Actor && !Actor->IsPendingKill())
+		{
+			ClassifyActor(Actor);
+		}
+	}
+}
+
+void AInteractableRegistry::UnregisterLevel(ULevel* Level)
+{
+	for (auto It = Constraints.CreateIterator(); It; ++It)
+	{
+		if (!It.Key().IsValid() || It.Key()->GetLevel() == Level)
+		{
+			It.RemoveCurrent();
+		}
+	}
+
+	for (auto It = Interactables.CreateIterator(); It; ++It)
+	{
+		if (!It.Key().IsValid() || It.Key()->GetLevel() == Level)
+		{
+			//Remember where the item was left and whether the drawer was open for when the level comes back
+			UInteractableComponent* Interactable = It.Value().Get();
+			if (It.Key().IsValid() && Interactable && Interactable->GetMesh())
+			{
+				FInteractableSnapshot& Snapshot = Snapshots.Add(It.Key()->GetPathName());
+				Snapshot.AssetState = Interactable->AssetState;
+				Snapshot.Transform = Interactable->GetMesh()->GetComponentTransform();
+				Snapshot.bAwake = Interactable->GetMesh()->RigidBodyIsAwake();
+			}
+			if (Interactable)
+			{
+				SpatialIndex.Remove(Interactable);
+			}
+			It.RemoveCurrent();
+		}
+	}
+	SET_DWORD_STAT(STAT_KitchenRegisteredInteractables, Interactables.Num());
+}
+
+bool AInteractableRegistry::RegisterIndexedLevel(ULevel* Level, const UInteractableIndex* Index)
+{
+	//Actors are looked up by name in their level, none is classified again
+	TArray<AActor*, TInlineAllocator<64>> ConstraintActors;
+	for (const FName& ActorName : Index->ConstraintActors)
+	{
+		AActor* Actor = FindObjectFast<AActor>(Level, ActorName);
+		if (!Actor)
+		{
+			return false;
+		}
+		ConstraintActors.Add(Actor);
+	}
+
+	TArray<AActor*> Actors;
+	Actors.Reserve(Index->Entries.Num());
+	for (const FInteractableIndexEntry& Entry : Index->Entries)
+	{
+		AActor* Actor = FindObjectFast<AActor>(Level, Entry.ActorName);
+		if (!Actor)
+		{
+			return false;
+		}
+		Actors.Add(Actor);
+	}
+
+	//Constraints first, drawers may come before the constraint holding them
+	for (AActor* Actor : ConstraintActors)
+	{
+		if (!Actor->IsPendingKill())
+		{
+			AddConstraints(Actor);
+		}
+	}
+
+	for (int32 EntryIndex = 0; EntryIndex < Actors.Num(); EntryIndex++)
+	{
+		if (!Actors[EntryIndex]->IsPendingKill())
+		{
+			AddClassifiedActor(Actors[EntryIndex], Index->Entries[EntryIndex].Kind);
+		}
+	}
+	return true;
+}
+
+void AInteractableRegistry::ClassifyActor(AActor* Actor)
+{
+	//Command used for determining the exact name of an actor. Only useful when designing.
+	//UE_LOG(LogTemp, Warning, TEXT("Actor name: %s"), *Actor->GetName());
+
+	EInteractableKind Kind;
+	if (UInteractableIndex::ClassifyActor(Actor, Kind))
+	{
+		AddClassifiedActor(Actor, Kind);
+	}
+}
+
+void AInteractableRegistry::AddClassifiedActor(AActor* Actor, EInteractableKind Kind)
+{
+	//Actors set up with the component in the editor register themselves
+	if (Interactables.Contains(Actor) || Actor->FindComponentByClass<UInteractableComponent>())
+	{
+		return;
+	}
+	FindOrAddInteractable(Actor, Kind);
+}
+
+UInteractableComponent* AInteractableRegistry::FindOrAddInteractable(AActor* Actor, EInteractableKind Kind)
+{
+	UInteractableComponent* Interactable = Find(Actor);
+	if (!Interactable)
+	{
+		Interactable = Actor->FindComponentByClass<UInteractableComponent>();
+	}
+	if (Interactable)
+	{
+		Register(Interactable);
+	}
+	else
+	{
+		Interactable = NewObject<UInteractableComponent>(Actor, TEXT("Interactable"));
+		Interactable->Kind = Kind;
+		Interactable->RegisterComponent();
+
+		//Added to an actor which already began play, the component registered itself from its BeginPlay
+		if (!Interactable->HasBegunPlay())
+		{
+			Register(Interactable);
+		}
+	}
+	return Interactable;
+}
+
+void AInteractableRegistry::Register(UInteractableComponent* Interactable)
+{
+	//Registered once, whether by its BeginPlay or by the level registration which found it
+	AActor* Owner = Interactable->GetOwner();
+	if (!Owner || Find(Owner) == Interactable)
+	{
+		return;
+	}
+
+	Interactable->CacheMesh();
+
+	//Interactables are the only things blocking the focus trace of an empty hand
+	if (Interactable->GetMesh())
+	{
+		Interactable->GetMesh()->SetCollisionResponseToChannel(ECC_Interactable, ECR_Block);
+	}
+	if (Catalog && Catalog->IsLoaded())
+	{
+		Catalog->ApplyTo(Interactable);
+	}
+	Interactables.Add(Owner, Interactable);
+	SET_DWORD_STAT(STAT_KitchenRegisteredInteractables, Interactables.Num());
+
+	//Components added by the registry have the same name on the server and the clients, the state of drawers is sent to them
+	const ENetMode NetMode = GetNetMode();
+	if (Interactable->Kind == EInteractableKind::Openable && NetMode != NM_Standalone)
+	{
+		Interactable->SetNetAddressable();
+	}
+
+	//Clients receive the movement of the interactables from the server, they never send it
+	if (Interactable->Kind != EInteractableKind::Handle && (NetMode == NM_DedicatedServer || NetMode == NM_ListenServer))
+	{
+		SetupReplication(Interactable);
+	}
+
+	//The drive takes the placed pose as closed, so it is set up before a saved pose is restored
+	if (Interactable->Kind == EInteractableKind::Openable && !Interactable->GetDrive())
+	{
+		SetupDrive(Interactable);
+	}
+	RestoreSnapshot(Interactable);
+	UpdateLocation(Interactable);
+
+	//Items are put to sleep as soon as they rest
+	if (Interactable->IsItem())
+	{
+		ASettleManager::Get(GetWorld())->Track(Interactable);
+	}
+
+	//Handles forward the actions to the drawer or door they are attached to
+	if (Interactable->Kind == EInteractableKind::Handle && !Interactable->GetOpenTarget())
+	{
+		AActor* Openable = Owner->GetAttachParentActor();
+		if (Openable)
+		{
+			Interactable->SetOpenTarget(FindOrAddInteractable(Openable, EInteractableKind::Openable));
+		}
+	}
+}
+
+void AInteractableRegistry::AddConstraints(AActor* Actor)
+{
+	TInlineComponentArray<UPhysicsConstraintComponent*> ActorConstraints;
+	Actor->GetComponents(ActorConstraints);
+	for (UPhysicsConstraintComponent* Constraint : ActorConstraints)
+	{
+		//One side is usually the furniture or the world, both are recorded
+		if (Constraint->ConstraintActor1)
+		{
+			Constraints.Add(Constraint->ConstraintActor1, Constraint);
+		}
+		if (Constraint->ConstraintActor2)
+		{
+			Constraints.Add(Constraint->ConstraintActor2, Constraint);
+		}
+	}
+}
+
+void AInteractableRegistry::SetupDrive(UInteractableComponent* Openable)
+{
+	AActor* Owner = Openable->GetOwner();
+	UOpenableDriveComponent* Drive = Owner->FindComponentByClass<UOpenableDriveComponent>();
+	if (!Drive)
+	{
+		Drive = NewObject<UOpenableDriveComponent>(Owner, TEXT("OpenableDrive"));
+		Drive->RegisterComponent();
+	}
+
+	const TWeakObjectPtr<UPhysicsConstraintComponent>* Constraint = Constraints.Find(Owner);
+	Drive->Initialize(Openable, Constraint ? Constraint->Get() : nullptr);
+	Openable->SetDrive(Drive);
+}
+
+void AInteractableRegistry::SetupReplication(UInteractableComponent* Interactable)
+{
+	//The clients cannot tell a drawer stopped half way from an open one, they get the state measured here
+	if (Interactable->Kind == EInteractableKind::Openable)
+	{
+		Interactable->SetIsReplicated(true);
+	}
+
+	AActor* Owner = Interactable->GetOwner();
+	if (Owner->GetIsReplicated())
+	{
+		return;
+	}
+
+	//Placed actors are already on the clients as they were loaded, nothing is sent until they move
+	Owner->NetDormancy = Owner->bNetStartup ? DORM_Initial : DORM_DormantAll;
+	Owner->NetCullDistanceSquared = FMath::Square(NetCullDistance);
+	Owner->NetUpdateFrequency = NetUpdateFrequency;
+	Owner->SetReplicates(true);
+	Owner->SetReplicateMovement(true);
+}
+
+void AInteractableRegistry::RestoreSnapshot(UInteractableComponent* Interactable)
+{
+	FInteractableSnapshot Snapshot;
+	if (Snapshots.RemoveAndCopyValue(Interactable->GetOwner()->GetPathName(), Snapshot))
+	{
+		ApplySnapshot(Interactable, Snapshot);
+	}
+}
+
+void AInteractableRegistry::ApplySnapshot(UInteractableComponent* Interactable, const FInteractableSnapshot& Snapshot)
+{
+	UStaticMeshComponent* Mesh = Interactable->GetMesh();
+	if (!Mesh)
+	{
+		Interactable->AssetState = Snapshot.AssetState;
+		return;
+	}
+
+	//The drive has to hold the saved pose, otherwise it pulls the drawer back to its old target
+	if (Interactable->GetDrive())
+	{
+		Interactable->GetDrive()->RestorePose(Snapshot.Transform, Snapshot.AssetState);
+	}
+	else
+	{
+		Interactable->AssetState = Snapshot.AssetState;
+		Mesh->SetWorldTransform(Snapshot.Transform, false, nullptr, ETeleportType::TeleportPhysics);
+		if (Mesh->IsSimulatingPhysics())
+		{
+			Mesh->PutRigidBodyToSleep();
+		}
+	}
+
+	if (Snapshot.bAwake && Mesh->IsSimulatingPhysics())
+	{
+		Mesh->WakeRigidBody();
+	}
+
+	//The clients see the new pose even if the body stays asleep
+	Interactable->FlushNetState();
+}
+
+void AInteractableRegistry::Unregister(UInteractableComponent* Interactable)
+{
+	AActor* Owner = Interactable->GetOwner();
+	if (Owner && Find(Owner) == Interactable)
+	{
+		Interactables.Remove(Owner);
+		SpatialIndex.Remove(Interactable);
+		SET_DWORD_STAT(STAT_KitchenRegisteredInteractables, Interactables.Num());
+	}
+}
+
+UInteractableComponent* AInteractableRegistry::Find(const AActor* Actor) const
+{
+	const TWeakObjectPtr<UInteractableComponent>* Interactable = Interactables.Find(Actor);
+	return Interactable ? Interactable->Get() : nullptr;
+}
+
+UInteractableComponent* AInteractableRegistry::FindInteractionTarget(const AActor* Actor) const
+{
+	UInteractableComponent* Interactable = Find(Actor);
+	if (Interactable && !Interactable->IsItem())
+	{
+		return Interactable->GetOpenTarget();
+	}
+	return Interactable;
+}
+
+void AInteractableRegistry::UpdateLocation(UInteractableComponent* Interactable)
+{
+	if (Interactable->Kind == EInteractableKind::Handle)
+	{
+		return;
+	}
+
+	//The center of the bounds, not the pivot, which is often on a corner of the mesh
+	UStaticMeshComponent* Mesh = Interactable->GetMesh();
+	const FVector Location = Mesh ? Mesh->Bounds.Origin : Interactable->GetOwner()->GetActorLocation();
+	SpatialIndex.Update(Interactable, Location);
+}
+
+void AInteractableRegistry::GetInteractables(EInteractableKind Kind, TArray<UInteractableComponent*>& OutInteractables) const
+{
+	for (const auto& Entry : Interactables)
+	{
+		UInteractableComponent* Interactable = Entry.Value.Get();
+		if (Interactable && Interactable->Kind == Kind)
+		{
+			OutInteractables.Add(Interactable);
+		}
+	}
+}
+
+bool AInteractableRegistry::HasHeldItems(const ULevel* Level) const
+{
+	for (const auto& Entry : Interactables)
+	{
+		UInteractableComponent* Interactable = Entry.Value.Get();
+		if (Interactable && Interactable->bHeld && Entry.Key.IsValid() && Entry.Key->GetLevel() == Level)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+void AInteractableRegistry::OnLevelAdded(ULevel* Level, UWorld* World)
+{
+	if (Level && World == GetWorld())
+	{
+		RegisterLevel(Level);
+	}
+}
+
+void AInteractableRegistry::OnLevelRemoved(ULevel* Level, UWorld* World)
+{
+	//A null level means the whole world is being torn down
+	if (World == GetWorld())
+	{
+		if (Level)
+		{
+			UnregisterLevel(Level);
+		}
+		else
+		{
+			Interactables.Empty();
+			SpatialIndex.Reset();
+			SET_DWORD_STAT(STAT_KitchenRegisteredInteractables, 0);
+		}
+	}
+}
+
+void AInteractableRegistry::OnActorSpawned(AActor* Actor)
+{
+	if (Actor && Actor != this)
+	{
+		AddConstraints(Actor);
+		ClassifyActor(Actor);
+	}
+}
@@ -0,0 +1,160 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "GameFramework/Info.h"
+#include "InteractableComponent.h"
+#include "InteractableGrid.h"
+#include "InteractableRegistry.generated.h"
+
+class AItemCatalog;
+class UInteractableIndex;
+
+//State of an interactable kept while its level is unloaded
+struct FInteractableSnapshot
+{
+	EAssetState AssetState;
+	FTransform Transform;
+	bool bAwake;
+};
+
+/**
+ * World-level registry of the interactive actors of the kitchen (drawers, doors and items).
+ * Interactable components register themselves when they begin play and leave when they end play,
+ * so spawned and streamed actors are covered and the characters never scan the world. Actors
+ * placed without a component are taken from the interactable index of their level, built with the
+ * BuildInteractableIndex commandlet; levels without an index are scanned.
+ * On a server the items, drawers and doors are made to replicate their movement, dormant while
+ * they rest and only to the clients closer than NetCullDistance; drawers and doors also replicate
+ * their open/closed state.
+ */
+UCLASS(config = Game)
+class KITCHEN_API AInteractableRegistry : public AInfo
+{
+	GENERATED_BODY()
+
+public:
+	AInteractableRegistry();
+
+	//Returns the registry of the world, spawning it the first time it is requested
+	static AInteractableRegistry* Get(UWorld* World);
+
+	//Returns the registry of the world if it already exists
+	static AInteractableRegistry* FindInWorld(UWorld* World);
+
+	// Called when the game ends or when destroyed
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	// Called every frame, only in builds with stats
+	virtual void Tick(float DeltaSeconds) override;
+
+	//Adds an interactable to the registry and caches its mesh
+	void Register(UInteractableComponent* Interactable);
+
+	//Removes the interactable from the registry, does nothing if it was not registered
+	void Unregister(UInteractableComponent* Interactable);
+
+	//Returns the interactable component of the actor, nullptr if the actor is not interactive
+	UInteractableComponent* Find(const AActor* Actor) const;
+
+	//Returns the component receiving the action when the actor is clicked (the drawer for one of its handles)
+	UInteractableComponent* FindInteractionTarget(const AActor* Actor) const;
+
+	//Number of actors currently registered
+	int32 GetNumRegistered() const { return Interactables.Num(); }
+
+	//Appends all registered interactables of the given kind
+	void GetInteractables(EInteractableKind Kind, TArray<UInteractableComponent*>& OutInteractables) const;
+
+	//Returns true if a character holds an item of the level, which must not be unloaded then
+	bool HasHeldItems(const ULevel* Level) const;
+
+	//Moves an item, drawer or door in the spatial index; called whenever it moved
+	void UpdateLocation(UInteractableComponent* Interactable);
+
+	//Distance beyond which a client is not sent the movement of an item, drawer or door, in cm
+	UPROPERTY(config)
+	float NetCullDistance;
+
+	//Times per second a moving item, drawer or door is considered for replication
+	UPROPERTY(config)
+	float NetUpdateFrequency;
+
+	//Items, drawers and doors within Radius of Origin, closest first
+	void FindInRadius(const FVector& Origin, float Radius, TArray<FInteractableQueryResult>& OutResults) const { SpatialIndex.FindInRadius(Origin, Radius, OutResults); }
+
+	//Items, drawers and doors within Radius of Origin and inside the cone around Direction, closest first
+	void FindInCone(const FVector& Origin, const FVector& Direction, float HalfAngleDegrees, float Radius, TArray<FInteractableQueryResult>& OutResults) const { SpatialIndex.FindInCone(Origin, Direction, HalfAngleDegrees, Radius, OutResults); }
+
+	//Teleports a registered interactable to a saved state, asleep unless it was saved moving
+	void ApplySnapshot(UInteractableComponent* Interactable, const FInteractableSnapshot& Snapshot);
+
+	//States kept for the interactables of unloaded levels
+	const TMap<FString, FInteractableSnapshot>& GetSnapshots() const { return Snapshots; }
+
+	//Replaces the kept state of an actor of an unloaded level, applied when its level becomes visible
+	void SetSnapshot(const FString& ActorPath, const FInteractableSnapshot& Snapshot) { Snapshots.Add(ActorPath, Snapshot); }
+
+	//Forgets the states of the unloaded levels, which then come back as placed
+	void ResetSnapshots() { Snapshots.Reset(); }
+
+private:
+	//Hooks the registry to the world and registers the levels already visible
+	void Initialize();
+
+	//Registers the interactive actors of a level which became visible
+	void RegisterLevel(ULevel* Level);
+
+	//Registers the actors listed in the index of a level; returns false if the index no longer matches the level
+	bool RegisterIndexedLevel(ULevel* Level, const UInteractableIndex* Index);
+
+	//Removes all actors belonging to a level which is being removed from the world, keeping their state
+	void UnregisterLevel(ULevel* Level);
+
+	//Puts an interactable back in the state it had when its level was unloaded
+	void RestoreSnapshot(UInteractableComponent* Interactable);
+
+	//Adds an interactable component to actors placed without one, based on their name and tags
+	void ClassifyActor(AActor* Actor);
+
+	//Adds the interactable component of the given kind to an actor, unless it is already registered
+	void AddClassifiedActor(AActor* Actor, EInteractableKind Kind);
+
+	//Returns the interactable component of the actor, creating it if the actor has none
+	UInteractableComponent* FindOrAddInteractable(AActor* Actor, EInteractableKind Kind);
+
+	//Remembers which actors the physics constraints of an actor hold
+	void AddConstraints(AActor* Actor);
+
+	//Gives a drawer or door the drive moving it with the constraint holding it
+	void SetupDrive(UInteractableComponent* Openable);
+
+	//Makes an item, drawer or door replicate its movement from this server
+	void SetupReplication(UInteractableComponent* Interactable);
+
+	//Callbacks from the world
+	void OnLevelAdded(ULevel* Level, UWorld* World);
+	void OnLevelRemoved(ULevel* Level, UWorld* World);
+	void OnActorSpawned(AActor* Actor);
+
+	//Interactables keyed by their owner
+	TMap<TWeakObjectPtr<AActor>, TWeakObjectPtr<UInteractableComponent>> Interactables;
+
+	//Locations of the items, drawers and doors; handles are reached through their drawer
+	FInteractableGrid SpatialIndex;
+
+	//States of the interactables of unloaded levels, keyed by actor path
+	TMap<FString, FInteractableSnapshot> Snapshots;
+
+	//Catalog providing the type, grip and bounds of the items
+	UPROPERTY()
+	AItemCatalog* Catalog;
+
+	//Constraints keyed by the actor they hold, gathered when levels are added
+	TMap<TWeakObjectPtr<AActor>, TWeakObjectPtr<UPhysicsConstraintComponent>> Constraints;
+
+	//Handles used to unbind from the world delegates
+	FDelegateHandle LevelAddedHandle;
+	FDelegateHandle LevelRemovedHandle;
+	FDelegateHandle ActorSpawnedHandle;
+};
@@ -0,0 +1,61 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Kitchen.h"
+#include "InteractionPromptWidget.h"
+#include "MyCharacter.h"
+#include "Components/TextBlock.h"
+
+UInteractionPromptWidget::UInteractionPromptWidget(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
+{
+	PromptTextName = TEXT("DisplayText");
+	DetailTextName = TEXT("DisplayText0");
+
+	Character = nullptr;
+	PromptText = nullptr;
+	DetailText = nullptr;
+}
+
+void UInteractionPromptWidget::NativeConstruct()
+{
+	Super::NativeConstruct();
+
+	PromptText = Cast<UTextBlock>(GetWidgetFromName(PromptTextName));
+	DetailText = Cast<UTextBlock>(GetWidgetFromName(DetailTextName));
+	if (!PromptText || !DetailText)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("%s has no text block %s or %s, the interaction prompts are not shown"), *GetClass()->GetName(), *PromptTextName.ToString(), *DetailTextName.ToString());
+	}
+
+	//Created by the character for its own player
+	Character = Cast<AMyCharacter>(GetOwningPlayerPawn());
+	if (Character)
+	{
+		Character->OnInteractionStateChanged.AddUniqueDynamic(this, &UInteractionPromptWidget::OnInteractionStateChanged);
+		OnInteractionStateChanged(Character->InteractionState, 0);
+	}
+}
+
+void UInteractionPromptWidget::NativeDestruct()
+{
+	if (Character)
+	{
+		Character->OnInteractionStateChanged.RemoveDynamic(this, &UInteractionPromptWidget::OnInteractionStateChanged);
+		Character = nullptr;
+	}
+
+	Super::NativeDestruct();
+}
+
+void UInteractionPromptWidget::OnInteractionStateChanged(EInteractionState NewState, int32 RotationAxis)
+{
+	//The character already holds the texts of the new state
+	if (PromptText)
+	{
+		PromptText->SetText(Character->DisplayMessage);
+	}
+	if (DetailText)
+	{
+		DetailText->SetText(Character->DisplayMessage2);
+	}
+}
@@ -0,0 +1,48 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "Blueprint/UserWidget.h"
+#include "KitchenTypes.h"
+#include "InteractionPromptWidget.generated.h"
+
+class AMyCharacter;
+class UTextBlock;
+
+/**
+ * Parent of the HUD widget showing the interaction prompts. The texts are set when the character
+ * raises OnInteractionStateChanged and are left alone otherwise: the text blocks have no
+ * binding, so nothing is evaluated or converted while the prompts do not change.
+ */
+UCLASS()
+class KITCHEN_API UInteractionPromptWidget : public UUserWidget
+{
+	GENERATED_BODY()
+
+public:
+	UInteractionPromptWidget(const FObjectInitializer& ObjectInitializer);
+
+	virtual void NativeConstruct() override;
+	virtual void NativeDestruct() override;
+
+	//Text blocks of the widget showing DisplayMessage and DisplayMessage2
+	UPROPERTY(EditDefaultsOnly, Category = Prompt)
+	FName PromptTextName;
+
+	UPROPERTY(EditDefaultsOnly, Category = Prompt)
+	FName DetailTextName;
+
+private:
+	UFUNCTION()
+	void OnInteractionStateChanged(EInteractionState NewState, int32 RotationAxis);
+
+	//Character whose prompts are shown
+	UPROPERTY()
+	AMyCharacter* Character;
+
+	UPROPERTY()
+	UTextBlock* PromptText;
+
+	UPROPERTY()
+	UTextBlock* DetailText;
+};
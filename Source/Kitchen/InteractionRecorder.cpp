@@ -0,0 +1,425 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Kitchen.h"
+#include "InteractionRecorder.h"
+#include "InteractableComponent.h"
+#include "SettleManager.h"
+#include "KitchenWorldManager.h"
+#include "Containers/Queue.h"
+#include "HAL/RunnableThread.h"
+
+using namespace KitchenRecording;
+
+/**
+ * Streams the frame buffers of the recorder to disk. Filled buffers arrive through one
+ * single-producer queue and go back empty through another, so neither thread ever locks
+ * and buffers are reused instead of allocated every frame.
+ */
+class FRecordingWriter : public FRunnable
+{
+public:
+	FRecordingWriter(IFileHandle* InFile)
+		: File(InFile)
+		, WakeEvent(FPlatformProcess::GetSynchEventFromPool())
+		, Thread(nullptr)
+	{
+		Thread = FRunnableThread::Create(this, TEXT("KitchenRecordingWriter"), 0, TPri_BelowNormal);
+	}
+
+	virtual ~FRecordingWriter()
+	{
+		Shutdown();
+		FPlatformProcess::ReturnSynchEventToPool(WakeEvent);
+
+		TArray<uint8>* Buffer = nullptr;
+		while (FreeBuffers.Dequeue(Buffer))
+		{
+			delete Buffer;
+		}
+	}
+
+	//Game thread: returns an empty buffer, recycled when the writer has one
+	TArray<uint8>* AcquireBuffer()
+	{
+		TArray<uint8>* Buffer = nullptr;
+		if (!FreeBuffers.Dequeue(Buffer))
+		{
+			Buffer = new TArray<uint8>();
+			Buffer->Reserve(4096);
+		}
+		return Buffer;
+	}
+
+	//Game thread: hands a filled buffer over to the writer
+	void Submit(TArray<uint8>* Buffer)
+	{
+		PendingBuffers.Enqueue(Buffer);
+		WakeEvent->Trigger();
+	}
+
+	//Game thread: writes what is left and waits for the thread to finish
+	void Shutdown()
+	{
+		if (Thread)
+		{
+			bStopping = true;
+			WakeEvent->Trigger();
+			Thread->WaitForCompletion();
+			delete Thread;
+			Thread = nullptr;
+		}
+		delete File;
+		File = nullptr;
+	}
+
+	virtual uint32 Run() override
+	{
+		while (!bStopping)
+		{
+			WakeEvent->Wait(10);
+			WritePending();
+		}
+		WritePending();
+		File->Flush();
+		return 0;
+	}
+
+private:
+	void WritePending()
+	{
+		TArray<uint8>* Buffer = nullptr;
+		while (PendingBuffers.Dequeue(Buffer))
+		{
+			File->Write(Buffer->GetData(), Buffer->Num());
+			Buffer->Reset();
+			FreeBuffers.Enqueue(Buffer);
+		}
+	}
+
+	IFileHandle* File;
+	FEvent* WakeEvent;
+	FRunnableThread* Thread;
+	FThreadSafeBool bStopping;
+
+	TQueue<TArray<uint8>*, EQueueMode::Spsc> PendingBuffers;
+	TQueue<TArray<uint8>*, EQueueMode::Spsc> FreeBuffers;
+};
+
+AInteractionRecorder::AInteractionRecorder()
+{
+	//After the hands moved the held items and the characters acted
+	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.TickGroup = TG_PostUpdateWork;
+
+	Writer = nullptr;
+	FrameBuffer = nullptr;
+	NextActorId = 1;
+	LastFrameCounter = 0;
+}
+
+bool AInteractionRecorder::IsRecordingRequested()
+{
+	FString Unused;
+	return FParse::Param(FCommandLine::Get(), TEXT("KitchenRecord")) || FParse::Value(FCommandLine::Get(), TEXT("KitchenRecord="), Unused);
+}
+
+void AInteractionRecorder::BeginPlay()
+{
+	Super::BeginPlay();
+
+	FString FilePath;
+	if (!FParse::Value(FCommandLine::Get(), TEXT("KitchenRecord="), FilePath))
+	{
+		FilePath = FPaths::GameSavedDir() / TEXT("Recordings") / FString::Printf(TEXT("Kitchen-%s.krec"), *FDateTime::Now().ToString());
+	}
+
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	PlatformFile.CreateDirectoryTree(*FPaths::GetPath(FilePath));
+	IFileHandle* File = PlatformFile.OpenWrite(*FilePath);
+	if (!File)
+	{
+		UE_LOG(LogTemp, Error, TEXT("Kitchen recorder could not open %s"), *FilePath);
+		return;
+	}
+	UE_LOG(LogTemp, Log, TEXT("Kitchen recorder writing to %s"), *FilePath);
+
+	Writer = new FRecordingWriter(File);
+	FrameBuffer = Writer->AcquireBuffer();
+	LastFrameCounter = GFrameCounter;
+
+	//Header, little endian
+	for (int32 Index = 0; Index < 4; Index++)
+	{
+		WriteByte(*FrameBuffer, static_cast<uint8>(Magic >> (8 * Index)));
+	}
+	WriteByte(*FrameBuffer, static_cast<uint8>(Version));
+	WriteByte(*FrameBuffer, static_cast<uint8>(Version >> 8));
+}
+
+void AInteractionRecorder::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (Writer)
+	{
+		WriteFinalState();
+		Writer->Submit(FrameBuffer);
+		FrameBuffer = nullptr;
+		delete Writer;
+		Writer = nullptr;
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void AInteractionRecorder::RecordEvent(ERecordedEvent Event, const AActor* Character, UInteractableComponent* Target, int32 Value)
+{
+	if (!FrameBuffer)
+	{
+		return;
+	}
+	SCOPE_CYCLE_COUNTER(STAT_KitchenRecord);
+
+	const uint32 CharacterId = GetActorId(Character);
+	const uint32 TargetId = Target ? GetActorId(Target->GetOwner()) : 0;
+
+	WriteByte(*FrameBuffer, static_cast<uint8>(ERecordType::Event));
+	WriteByte(*FrameBuffer, static_cast<uint8>(Event));
+	WriteVarUInt(*FrameBuffer, CharacterId);
+	WriteVarUInt(*FrameBuffer, TargetId);
+	WriteVarInt(*FrameBuffer, Value);
+
+	//Items in hand are not simulated, follow them until they are dropped
+	UStaticMeshComponent* Mesh = Target ? Target->GetMesh() : nullptr;
+	if (Mesh && Event == ERecordedEvent::Pick)
+	{
+		HeldBodies.AddUnique(Mesh);
+	}
+	else if (Mesh && Event == ERecordedEvent::Drop)
+	{
+		HeldBodies.Remove(Mesh);
+		RecordTransform(Mesh);
+	}
+}
+
+void AInteractionRecorder::Tick(float DeltaSeconds)
+{
+	Super::Tick(DeltaSeconds);
+
+	if (!FrameBuffer)
+	{
+		return;
+	}
+	SCOPE_CYCLE_COUNTER(STAT_KitchenRecord);
+
+	WriteInputs();
+
+	//Items carried, and items falling or rolling after a drop
+	for (int32 Index = HeldBodies.Num() - 1; Index >= 0; Index--)
+	{
+		if (UPrimitiveComponent* Body = HeldBodies[Index].Get())
+		{
+			RecordTransform(Body);
+		}
+		else
+		{
+			HeldBodies.RemoveAtSwap(Index);
+		}
+	}
+	ASettleManager* SettleManager = FindWorldManager<ASettleManager>(GetWorld());
+	if (SettleManager)
+	{
+		for (const TWeakObjectPtr<UPrimitiveComponent>& Body : SettleManager->GetAwakeBodies())
+		{
+			if (Body.IsValid())
+			{
+				RecordTransform(Body.Get());
+			}
+		}
+	}
+
+	WriteByte(*FrameBuffer, static_cast<uint8>(ERecordType::Frame));
+	WriteVarUInt(*FrameBuffer, GFrameCounter - LastFrameCounter);
+	WriteVarUInt(*FrameBuffer, static_cast<uint64>(FMath::RoundToInt(DeltaSeconds * 1000000.f)));
+	LastFrameCounter = GFrameCounter;
+
+	SET_DWORD_STAT(STAT_KitchenRecordBytes, FrameBuffer->Num());
+	Writer->Submit(FrameBuffer);
+	FrameBuffer = Writer->AcquireBuffer();
+}
+
+void AInteractionRecorder::RecordAxis(const AActor* Character, EInputAxis Axis, float Value)
+{
+	//Axes are polled every frame, so this also keeps track of the control rotation of the character
+	FFrameInput& Input = Inputs.FindOrAdd(const_cast<AActor*>(Character));
+	Input.Axes[Axis] = FMath::RoundToInt(Value * InputScale);
+}
+
+void AInteractionRecorder::RecordAction(const AActor* Character, EInputAction Action)
+{
+	FFrameInput& Input = Inputs.FindOrAdd(const_cast<AActor*>(Character));
+	Input.Actions |= Action;
+}
+
+void AInteractionRecorder::WriteInputs()
+{
+	for (auto It = Inputs.CreateIterator(); It; ++It)
+	{
+		const APawn* Pawn = Cast<APawn>(It.Key().Get());
+		if (!Pawn)
+		{
+			It.RemoveCurrent();
+			continue;
+		}
+		FFrameInput& Input = It.Value();
+
+		const FRotator Rotation = Pawn->GetControlRotation();
+		const int32 ControlRotation[3] =
+		{
+			FMath::RoundToInt(Rotation.Pitch * RotationScale),
+			FMath::RoundToInt(Rotation.Yaw * RotationScale),
+			FMath::RoundToInt(Rotation.Roll * RotationScale)
+		};
+
+		uint32 Mask = 0;
+		for (int32 Axis = 0; Axis < NumInputAxes; Axis++)
+		{
+			if (Input.Axes[Axis])
+			{
+				Mask |= 1 << Axis;
+			}
+		}
+		for (int32 Component = 0; Component < 3; Component++)
+		{
+			if (ControlRotation[Component] != Input.ControlRotation[Component])
+			{
+				Mask |= 1 << (ControlRotationBit + Component);
+			}
+		}
+
+		//Standing still without touching anything costs nothing
+		if (Mask || Input.Actions)
+		{
+			const uint32 CharacterId = GetActorId(Pawn);
+			WriteByte(*FrameBuffer, static_cast<uint8>(ERecordType::Input));
+			WriteVarUInt(*FrameBuffer, CharacterId);
+			WriteByte(*FrameBuffer, Input.Actions);
+			WriteVarUInt(*FrameBuffer, Mask);
+			for (int32 Axis = 0; Axis < NumInputAxes; Axis++)
+			{
+				if (Mask & (1 << Axis))
+				{
+					WriteVarInt(*FrameBuffer, Input.Axes[Axis]);
+				}
+			}
+			for (int32 Component = 0; Component < 3; Component++)
+			{
+				if (Mask & (1 << (ControlRotationBit + Component)))
+				{
+					WriteVarInt(*FrameBuffer, ControlRotation[Component]);
+					Input.ControlRotation[Component] = ControlRotation[Component];
+				}
+			}
+		}
+
+		FMemory::Memzero(Input.Axes);
+		Input.Actions = 0;
+	}
+}
+
+void AInteractionRecorder::WriteFinalState()
+{
+	//The registry may already be gone when the world tears down, look at the components directly
+	UWorld* World = GetWorld();
+	for (TObjectIterator<UInteractableComponent> It; It; ++It)
+	{
+		UInteractableComponent* Interactable = *It;
+		if (Interactable->GetWorld() != World || Interactable->IsPendingKill())
+		{
+			continue;
+		}
+
+		if (Interactable->IsItem() && Interactable->GetMesh())
+		{
+			RecordTransform(Interactable->GetMesh());
+		}
+		else if (Interactable->Kind == EInteractableKind::Openable)
+		{
+			const uint32 OpenableId = GetActorId(Interactable->GetOwner());
+			WriteByte(*FrameBuffer, static_cast<uint8>(ERecordType::State));
+			WriteVarUInt(*FrameBuffer, OpenableId);
+			WriteByte(*FrameBuffer, static_cast<uint8>(Interactable->AssetState));
+		}
+	}
+}
+
+uint32 AInteractionRecorder::GetActorId(const AActor* Actor)
+{
+	if (!Actor)
+	{
+		return 0;
+	}
+
+	TWeakObjectPtr<AActor> Key(const_cast<AActor*>(Actor));
+	if (const uint32* Id = ActorIds.Find(Key))
+	{
+		return *Id;
+	}
+
+	//Only reached when an actor is seen for the first time or its level was loaded again; the
+	//actors of unloaded levels are forgotten then
+	for (auto It = ActorIds.CreateIterator(); It; ++It)
+	{
+		if (!It.Key().IsValid())
+		{
+			It.RemoveCurrent();
+		}
+	}
+
+	//An actor loaded again is already named in the recording
+	const FString PathName = Actor->GetPathName();
+	if (const uint32* Id = ActorIdsByPath.Find(PathName))
+	{
+		ActorIds.Add(Key, *Id);
+		return *Id;
+	}
+
+	const uint32 Id = NextActorId++;
+	ActorIdsByPath.Add(PathName, Id);
+	ActorIds.Add(Key, Id);
+	WriteByte(*FrameBuffer, static_cast<uint8>(ERecordType::Name));
+	WriteVarUInt(*FrameBuffer, Id);
+	WriteString(*FrameBuffer, PathName);
+	return Id;
+}
+
+void AInteractionRecorder::RecordTransform(UPrimitiveComponent* Body)
+{
+	//Deltas follow the id, which readers accumulate, and not the body, which a reload replaces
+	const uint32 ItemId = GetActorId(Body->GetOwner());
+	const FQuantizedTransform Current(Body->GetComponentLocation(), Body->GetComponentRotation());
+	FQuantizedTransform& Last = LastTransforms.FindOrAdd(ItemId);
+
+	uint32 Mask = 0;
+	for (int32 Component = 0; Component < NumTransformComponents; Component++)
+	{
+		if (Current.Values[Component] != Last.Values[Component])
+		{
+			Mask |= 1 << Component;
+		}
+	}
+	if (!Mask)
+	{
+		return;
+	}
+
+	WriteByte(*FrameBuffer, static_cast<uint8>(ERecordType::Transform));
+	WriteVarUInt(*FrameBuffer, ItemId);
+	WriteVarUInt(*FrameBuffer, Mask);
+	for (int32 Component = 0; Component < NumTransformComponents; Component++)
+	{
+		if (Mask & (1 << Component))
+		{
+			WriteVarInt(*FrameBuffer, static_cast<int64>(Current.Values[Component]) - Last.Values[Component]);
+		}
+	}
+	Last = Current;
+}
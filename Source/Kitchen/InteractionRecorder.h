@@ -0,0 +1,100 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "GameFramework/Info.h"
+#include "RecordingFormat.h"
+#include "InteractionRecorder.generated.h"
+
+class FRecordingWriter;
+class UInteractableComponent;
+
+/**
+ * Records the interactions of the characters and the transforms of the items they move, in the
+ * compact binary format described in RecordingFormat.h. The game thread only appends a few bytes
+ * per event to the buffer of the frame; at the end of the frame the buffer is handed to a writer
+ * thread through a lock-free queue and streamed to disk from there.
+ * The input of the characters is recorded too, so AKitchenReplay can play the session again.
+ * Started with -KitchenRecord, or -KitchenRecord=<file> to choose the output file.
+ */
+UCLASS()
+class KITCHEN_API AInteractionRecorder : public AInfo
+{
+	GENERATED_BODY()
+
+public:
+	AInteractionRecorder();
+
+	//Returns true if the game was started with recording enabled
+	static bool IsRecordingRequested();
+
+	// Called when the game starts or when spawned
+	virtual void BeginPlay() override;
+
+	// Called when the game ends or when destroyed
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	// Called at the end of every frame
+	virtual void Tick(float DeltaSeconds) override;
+
+	//Records an action of a character; picked items are followed until they rest again
+	void RecordEvent(KitchenRecording::ERecordedEvent Event, const AActor* Character, UInteractableComponent* Target, int32 Value);
+
+	//Records the value of an axis of a character for the current frame
+	void RecordAxis(const AActor* Character, KitchenRecording::EInputAxis Axis, float Value);
+
+	//Records an action pressed by a character during the current frame
+	void RecordAction(const AActor* Character, KitchenRecording::EInputAction Action);
+
+private:
+	//Input of a character during the current frame, quantized
+	struct FFrameInput
+	{
+		int32 Axes[KitchenRecording::NumInputAxes];
+		uint8 Actions;
+
+		//Control rotation written last, in 1/100 degree
+		int32 ControlRotation[3];
+
+		FFrameInput()
+			: Actions(0)
+		{
+			FMemory::Memzero(Axes);
+			FMemory::Memzero(ControlRotation);
+		}
+	};
+
+	//Writes the Input records of the frame and clears the input
+	void WriteInputs();
+
+	//Writes the transforms of all the items and the state of all the openables
+	void WriteFinalState();
+
+	//Returns the id of an actor, writing its Name record the first time
+	uint32 GetActorId(const AActor* Actor);
+
+	//Writes the transform of an item if it moved since it was last recorded
+	void RecordTransform(UPrimitiveComponent* Body);
+
+	//Writer thread and the buffer of the current frame
+	FRecordingWriter* Writer;
+	TArray<uint8>* FrameBuffer;
+
+	//Ids of the actors already named in the recording, by path name so an actor keeps its id when its level is loaded again
+	TMap<FString, uint32> ActorIdsByPath;
+
+	//Ids of the live actors, saving the path name lookup every frame
+	TMap<TWeakObjectPtr<AActor>, uint32> ActorIds;
+	uint32 NextActorId;
+
+	//Items in hand, recorded every frame whether the settle manager sees them or not
+	TArray<TWeakObjectPtr<UPrimitiveComponent>> HeldBodies;
+
+	//Last recorded transform of every item which moved, by actor id
+	TMap<uint32, KitchenRecording::FQuantizedTransform> LastTransforms;
+
+	//Input of the characters recorded during the frame
+	TMap<TWeakObjectPtr<AActor>, FFrameInput> Inputs;
+
+	uint64 LastFrameCounter;
+};
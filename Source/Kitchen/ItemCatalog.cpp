@@ -0,0 +1,108 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Kitchen.h"
+#include "ItemCatalog.h"
+#include "InteractableRegistry.h"
+#include "InteractableComponent.h"
+#include "KitchenWorldManager.h"
+
+AItemCatalog::AItemCatalog()
+{
+	//The catalog only reacts to the end of the loads
+	PrimaryActorTick.bCanEverTick = false;
+
+	ItemTable = FStringAssetReference();
+	LoadedTable = nullptr;
+	bLoaded = false;
+}
+
+AItemCatalog* AItemCatalog::Get(UWorld* World)
+{
+	return GetWorldManager<AItemCatalog>(World);
+}
+
+void AItemCatalog::BeginPlay()
+{
+	Super::BeginPlay();
+
+	if (!ItemTable.IsValid())
+	{
+		return;
+	}
+	Streamable.RequestAsyncLoad(ItemTable, FStreamableDelegate::CreateUObject(this, &AItemCatalog::OnTableLoaded));
+}
+
+void AItemCatalog::OnTableLoaded()
+{
+	LoadedTable = Cast<UDataTable>(ItemTable.ResolveObject());
+	if (!LoadedTable || LoadedTable->RowStruct != FKitchenItemRow::StaticStruct())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Item catalog %s could not be loaded, items keep the default values"), *ItemTable.ToString());
+		return;
+	}
+
+	TArray<FStringAssetReference> Meshes;
+	for (const auto& Entry : LoadedTable->RowMap)
+	{
+		const FKitchenItemRow* Row = reinterpret_cast<const FKitchenItemRow*>(Entry.Value);
+		if (!Row->Mesh.IsNull())
+		{
+			Meshes.AddUnique(Row->Mesh.ToStringReference());
+		}
+	}
+	Streamable.RequestAsyncLoad(Meshes, FStreamableDelegate::CreateUObject(this, &AItemCatalog::OnMeshesLoaded));
+}
+
+void AItemCatalog::OnMeshesLoaded()
+{
+	if (!LoadedTable)
+	{
+		return;
+	}
+
+	for (const auto& Entry : LoadedTable->RowMap)
+	{
+		const FKitchenItemRow* Row = reinterpret_cast<const FKitchenItemRow*>(Entry.Value);
+		UStaticMesh* Mesh = Row->Mesh.Get();
+		if (!Mesh)
+		{
+			continue;
+		}
+		LoadedMeshes.AddUnique(Mesh);
+		FKitchenItemInfo& Info = Items.Add(Mesh);
+		Info.Row = *Row;
+		Info.LocalBounds = Mesh->GetBoundingBox();
+	}
+	bLoaded = true;
+	UE_LOG(LogTemp, Log, TEXT("Item catalog loaded: %d items"), Items.Num());
+
+	//Items registered while the catalog was loading
+	AInteractableRegistry* Registry = AInteractableRegistry::FindInWorld(GetWorld());
+	if (Registry)
+	{
+		TArray<UInteractableComponent*> RegisteredItems;
+		Registry->GetInteractables(EInteractableKind::Item, RegisteredItems);
+		for (UInteractableComponent* Item : RegisteredItems)
+		{
+			ApplyTo(Item);
+		}
+	}
+}
+
+const FKitchenItemInfo* AItemCatalog::FindItem(const UStaticMesh* Mesh) const
+{
+	return Mesh ? Items.Find(Mesh) : nullptr;
+}
+
+void AItemCatalog::ApplyTo(UInteractableComponent* Item) const
+{
+	if (!Item || !Item->IsItem() || !Item->GetMesh())
+	{
+		return;
+	}
+	const FKitchenItemInfo* Info = FindItem(Item->GetMesh()->StaticMesh);
+	if (Info)
+	{
+		Item->ApplyItemInfo(*Info);
+	}
+}
@@ -0,0 +1,66 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "GameFramework/Info.h"
+#include "Engine/StreamableManager.h"
+#include "KitchenTypes.h"
+#include "ItemCatalog.generated.h"
+
+class UInteractableComponent;
+
+/**
+ * Maps item meshes to their type, grip pose, mass and bounds. The rows come from the data table
+ * set in the game config and are loaded asynchronously when the game starts, together with their
+ * meshes; the bounds are computed once per mesh. Items registered before the catalog is ready
+ * keep the default values until it finishes loading.
+ */
+UCLASS(config = Game)
+class KITCHEN_API AItemCatalog : public AInfo
+{
+	GENERATED_BODY()
+
+public:
+	AItemCatalog();
+
+	//Returns the catalog of the world, spawning it (and starting the load) the first time it is requested
+	static AItemCatalog* Get(UWorld* World);
+
+	// Called when the game starts or when spawned
+	virtual void BeginPlay() override;
+
+	//Returns the entry of a mesh, nullptr if the mesh is not in the catalog or the catalog is still loading
+	const FKitchenItemInfo* FindItem(const UStaticMesh* Mesh) const;
+
+	//Applies the catalog entry of its mesh to an item, if there is one
+	void ApplyTo(UInteractableComponent* Item) const;
+
+	FORCEINLINE bool IsLoaded() const { return bLoaded; }
+
+	//Data table with FKitchenItemRow rows, none until one is created in the editor; when it is, set it
+	//in DefaultGame.ini and add its directory to DirectoriesToAlwaysCook, since only this path refers to it
+	UPROPERTY(config)
+	FStringAssetReference ItemTable;
+
+private:
+	//Called when the data table is loaded, requests the meshes of its rows
+	void OnTableLoaded();
+
+	//Called when the meshes are loaded, builds the entries and updates the registered items
+	void OnMeshesLoaded();
+
+	//Loads the table and the meshes without blocking the game thread
+	FStreamableManager Streamable;
+
+	UPROPERTY()
+	UDataTable* LoadedTable;
+
+	//Meshes of the catalog, kept loaded for the lifetime of the catalog
+	UPROPERTY()
+	TArray<UStaticMesh*> LoadedMeshes;
+
+	//Entries keyed by mesh
+	TMap<const UStaticMesh*, FKitchenItemInfo> Items;
+
+	bool bLoaded;
+};
@@ -0,0 +1,97 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Kitchen.h"
+#include "ItemPlacementSolver.h"
+
+FItemPlacementSolver::FItemPlacementSolver()
+{
+	LiftDistance = 2.f;
+	SearchDepth = 10.f;
+	RingRadii.Add(0.f);
+	RingRadii.Add(5.f);
+	RingRadii.Add(10.f);
+	CandidatesPerRing = 8;
+	SkinDistance = 0.2f;
+
+	//Up to 60 degrees
+	MinSupportNormalZ = 0.5f;
+}
+
+bool FItemPlacementSolver::FindPlacement(UPrimitiveComponent* Item, const FHitResult& Surface, const FComponentQueryParams& Params, FVector& OutLocation) const
+{
+	if (!Item || !Item->GetWorld() || !Surface.bBlockingHit)
+	{
+		return false;
+	}
+
+	//Sweeps start far enough from the surface for the whole item to be clear of it
+	const FVector Normal = Surface.ImpactNormal.GetSafeNormal();
+	const float Lift = Item->Bounds.SphereRadius + LiftDistance;
+
+	//Two directions in the plane of the surface for the candidate rings
+	FVector TangentX, TangentY;
+	Normal.FindBestAxisVectors(TangentX, TangentY);
+
+	//Rings are visited from the inside, so the first free candidate is the closest one
+	for (const float Radius : RingRadii)
+	{
+		const int32 NumCandidates = Radius > 0.f ? CandidatesPerRing : 1;
+		for (int32 Index = 0; Index < NumCandidates; Index++)
+		{
+			const float Angle = 2.f * PI * Index / NumCandidates;
+			const FVector SurfacePoint = Surface.ImpactPoint + Radius * (FMath::Cos(Angle) * TangentX + FMath::Sin(Angle) * TangentY);
+			if (TryCandidate(Item, SurfacePoint, Normal, Lift, Params, OutLocation))
+			{
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+bool FItemPlacementSolver::TryCandidate(UPrimitiveComponent* Item, const FVector& SurfacePoint, const FVector& Normal, float Lift, const FComponentQueryParams& Params, FVector& OutLocation) const
+{
+	UWorld* World = Item->GetWorld();
+	const FRotator Rotation = Item->GetComponentRotation();
+
+	//Sweep positions are component locations, keep the item centred over the candidate point
+	const FVector CenterOffset = Item->GetComponentLocation() - Item->Bounds.Origin;
+	const FVector Start = SurfacePoint + Normal * Lift + CenterOffset;
+	const FVector End = SurfacePoint - Normal * SearchDepth + CenterOffset;
+
+	TArray<FHitResult> Hits;
+	World->ComponentSweepMulti(Hits, Item, Start, End, Rotation, Params);
+
+	const FHitResult* Support = nullptr;
+	for (const FHitResult& Hit : Hits)
+	{
+		if (Hit.bBlockingHit)
+		{
+			Support = &Hit;
+			break;
+		}
+	}
+
+	//Starting inside something means the candidate is buried in clutter, and no support means a hole
+	if (!Support || Support->bStartPenetrating || Support->ImpactNormal.Z < MinSupportNormalZ)
+	{
+		return false;
+	}
+
+	//Stop just short of the contact and check nothing else intersects the final pose
+	const FVector SweepDirection = (End - Start).GetSafeNormal();
+	const FVector Location = Support->Location - SweepDirection * SkinDistance;
+
+	TArray<FOverlapResult> Overlaps;
+	World->ComponentOverlapMultiByChannel(Overlaps, Item, Location, Rotation, Item->GetCollisionObjectType(), Params);
+	for (const FOverlapResult& Overlap : Overlaps)
+	{
+		if (Overlap.bBlockingHit)
+		{
+			return false;
+		}
+	}
+
+	OutLocation = Location;
+	return true;
+}
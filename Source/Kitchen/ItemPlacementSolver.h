@@ -0,0 +1,46 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+/**
+ * Finds where a dropped item can rest without intersecting anything. The collision shape of the
+ * item is swept along the normal of the surface aimed at, from a few candidate points around the
+ * aimed point, and the closest pose which touches the surface without penetrating any geometry is
+ * kept. Placing items this way avoids the violent depenetration of items dropped inside clutter.
+ */
+struct KITCHEN_API FItemPlacementSolver
+{
+	//Distance above the surface the sweeps start from, in addition to the size of the item
+	float LiftDistance;
+
+	//Distance below the aimed surface the sweeps still look for a support
+	float SearchDepth;
+
+	//Distances of the candidate rings around the aimed point, the first ring is the point itself
+	TArray<float> RingRadii;
+
+	//Candidates on each ring after the first one
+	int32 CandidatesPerRing;
+
+	//Gap left between the item and its support, so it does not start in contact
+	float SkinDistance;
+
+	//Smallest Z of the support normal, steeper surfaces cannot hold the item
+	float MinSupportNormalZ;
+
+	FItemPlacementSolver();
+
+	/**
+	 * Looks for a resting location of the item around the surface hit.
+	 * @param Item - collision of the item, it keeps its current rotation
+	 * @param Surface - hit of the focus trace on the surface aimed at
+	 * @param Params - what the sweeps ignore: the character, the items it holds and the item itself, which the sweeps would hit
+	 * @param OutLocation - component location of the item on success
+	 * @return false if no candidate is free, the drop should be refused then
+	 */
+	bool FindPlacement(UPrimitiveComponent* Item, const FHitResult& Surface, const FComponentQueryParams& Params, FVector& OutLocation) const;
+
+private:
+	//Sweeps the item onto the surface from a candidate point; returns false if it cannot rest there
+	bool TryCandidate(UPrimitiveComponent* Item, const FVector& SurfacePoint, const FVector& Normal, float Lift, const FComponentQueryParams& Params, FVector& OutLocation) const;
+};
@@ -8,7 +8,13 @@ public class Kitchen : ModuleRules
 	{
 		PublicDependencyModuleNames.AddRange(new string[] { "Core", "CoreUObject", "Engine", "InputCore" });
 
-		PrivateDependencyModuleNames.AddRange(new string[] {  });
+		PrivateDependencyModuleNames.AddRange(new string[] { "AIModule", "Json", "UMG", "Slate", "SlateCore" });
+
+		// The editor commandlets use the convex decomposition, the asset registry and the widget blueprints of the editor
+		if (UEBuildConfiguration.bBuildEditor)
+		{
+			PrivateDependencyModuleNames.AddRange(new string[] { "UnrealEd", "AssetRegistry", "UMGEditor" });
+		}
 
 		// Uncomment if you are using Slate UI
 		// PrivateDependencyModuleNames.AddRange(new string[] { "Slate", "SlateCore" });
@@ -1,5 +1,52 @@
 // Fill out your copyright notice in the Description page of Project Settings.
 
 #include "Kitchen.h"
+#include "KitchenEventLog.h"
 
-IMPLEMENT_PRIMARY_GAME_MODULE( FDefaultGameModuleImpl, Kitchen, "Kitchen" );
+//Runs the services which live as long as the game module
+class FKitchenModule : public FDefaultGameModuleImpl
+{
+	virtual void StartupModule() override
+	{
+		FKitchenEventLog::Startup();
+	}
+
+	virtual void ShutdownModule() override
+	{
+		FKitchenEventLog::Shutdown();
+	}
+};
+
+IMPLEMENT_PRIMARY_GAME_MODULE( FKitchenModule, Kitchen, "Kitchen" );
+
+TAutoConsoleVariable<int32> CVarRefineFocusTrace(
+	TEXT("Kitchen.RefineFocusTrace"),
+	1,
+	TEXT("0: the focus trace only tests the simple collision of the interactables (use once the collision proxies are generated)\n")
+	TEXT("1: hits on interactables are refined against the triangles of their mesh"),
+	ECVF_Default);
+
+DEFINE_STAT(STAT_KitchenCharacterTick);
+DEFINE_STAT(STAT_KitchenFocusTrace);
+DEFINE_STAT(STAT_KitchenResolveMesh);
+DEFINE_STAT(STAT_KitchenOpenClose);
+DEFINE_STAT(STAT_KitchenPick);
+DEFINE_STAT(STAT_KitchenDrop);
+DEFINE_STAT(STAT_KitchenDrawHUD);
+DEFINE_STAT(STAT_KitchenFocusBatch);
+DEFINE_STAT(STAT_KitchenSettle);
+DEFINE_STAT(STAT_KitchenHighlight);
+DEFINE_STAT(STAT_KitchenRecord);
+DEFINE_STAT(STAT_KitchenSnapshot);
+DEFINE_STAT(STAT_KitchenScenarioLoad);
+
+DEFINE_STAT(STAT_KitchenRegisteredInteractables);
+DEFINE_STAT(STAT_KitchenHighlightedActors);
+DEFINE_STAT(STAT_KitchenHighlightUpdates);
+DEFINE_STAT(STAT_KitchenAwakeBodies);
+DEFINE_STAT(STAT_KitchenFocusBatchSize);
+DEFINE_STAT(STAT_KitchenSettlingItems);
+DEFINE_STAT(STAT_KitchenSleepingItems);
+DEFINE_STAT(STAT_KitchenLockedItems);
+DEFINE_STAT(STAT_KitchenRecordBytes);
+DEFINE_STAT(STAT_KitchenInteractionAllocations);
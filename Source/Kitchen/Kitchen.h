@@ -4,3 +4,38 @@
 
 #include "Engine.h"
 
+//Trace channel blocked only by interactables, declared in DefaultEngine.ini; walls do not block it, hits are confirmed on the visibility channel
+#define ECC_Interactable ECC_GameTraceChannel2
+
+//Whether focus hits on interactables are refined against their triangles
+extern KITCHEN_API TAutoConsoleVariable<int32> CVarRefineFocusTrace;
+
+//Stats of the kitchen gameplay code, visible with "stat Kitchen"
+DECLARE_STATS_GROUP(TEXT("Kitchen"), STATGROUP_Kitchen, STATCAT_Advanced);
+
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Character Tick"), STAT_KitchenCharacterTick, STATGROUP_Kitchen, KITCHEN_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Focus Trace"), STAT_KitchenFocusTrace, STATGROUP_Kitchen, KITCHEN_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Resolve Mesh"), STAT_KitchenResolveMesh, STATGROUP_Kitchen, KITCHEN_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Open Close Action"), STAT_KitchenOpenClose, STATGROUP_Kitchen, KITCHEN_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Pick To Inventory"), STAT_KitchenPick, STATGROUP_Kitchen, KITCHEN_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Drop From Inventory"), STAT_KitchenDrop, STATGROUP_Kitchen, KITCHEN_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Draw HUD"), STAT_KitchenDrawHUD, STATGROUP_Kitchen, KITCHEN_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Focus Trace Batch"), STAT_KitchenFocusBatch, STATGROUP_Kitchen, KITCHEN_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Settle Items"), STAT_KitchenSettle, STATGROUP_Kitchen, KITCHEN_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Apply Highlights"), STAT_KitchenHighlight, STATGROUP_Kitchen, KITCHEN_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Record Interactions"), STAT_KitchenRecord, STATGROUP_Kitchen, KITCHEN_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Publish Snapshot"), STAT_KitchenSnapshot, STATGROUP_Kitchen, KITCHEN_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Load Scenario"), STAT_KitchenScenarioLoad, STATGROUP_Kitchen, KITCHEN_API);
+
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Registered Interactables"), STAT_KitchenRegisteredInteractables, STATGROUP_Kitchen, KITCHEN_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Highlighted Actors"), STAT_KitchenHighlightedActors, STATGROUP_Kitchen, KITCHEN_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Highlight Render Updates"), STAT_KitchenHighlightUpdates, STATGROUP_Kitchen, KITCHEN_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Awake Physics Bodies"), STAT_KitchenAwakeBodies, STATGROUP_Kitchen, KITCHEN_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Focus Trace Batch Size"), STAT_KitchenFocusBatchSize, STATGROUP_Kitchen, KITCHEN_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Settling Items"), STAT_KitchenSettlingItems, STATGROUP_Kitchen, KITCHEN_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Sleeping Items"), STAT_KitchenSleepingItems, STATGROUP_Kitchen, KITCHEN_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Locked Items"), STAT_KitchenLockedItems, STATGROUP_Kitchen, KITCHEN_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Recorded Bytes Per Frame"), STAT_KitchenRecordBytes, STATGROUP_Kitchen, KITCHEN_API);
+
+//Cleared every frame, summed over the characters
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Interaction State Allocations"), STAT_KitchenInteractionAllocations, STATGROUP_Kitchen, KITCHEN_API);
@@ -0,0 +1,659 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Kitchen.h"
+#include "KitchenBenchmark.h"
+#include "MyCharacter.h"
+#include "InteractableRegistry.h"
+#include "InteractableComponent.h"
+#include "HandSlotComponent.h"
+#include "OpenableDriveComponent.h"
+#include "FocusTraceScheduler.h"
+#include "KitchenWorldManager.h"
+#include "EngineUtils.h"
+#include "AIController.h"
+
+void FKitchenPhysicsTimerTickFunction::ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent)
+{
+	if (Target && !Target->IsPendingKill())
+	{
+		Target->OnPhysicsTimestamp(bPhysicsStart);
+	}
+}
+
+FString FKitchenPhysicsTimerTickFunction::DiagnosticMessage()
+{
+	return bPhysicsStart ? TEXT("FKitchenPhysicsTimerTickFunction[Start]") : TEXT("FKitchenPhysicsTimerTickFunction[End]");
+}
+
+AKitchenBenchmark::AKitchenBenchmark()
+{
+	//The script runs before the character, like the input of a player controller would
+	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.TickGroup = TG_PrePhysics;
+
+	//Kitchen areas streamed into KitchenLevel
+	SublevelNames.Add(TEXT("FridgeLevel"));
+	SublevelNames.Add(TEXT("OvenLevel"));
+	SublevelNames.Add(TEXT("SinkLevel"));
+	SublevelNames.Add(TEXT("IslandLevel"));
+
+	WarmupTime = 3.f;
+	ApproachTimeout = 3.f;
+	CarryTime = 1.5f;
+
+	Character = nullptr;
+	TargetIndex = INDEX_NONE;
+	Phase = EBenchmarkPhase::LoadingLevels;
+	PhaseTime = 0.f;
+	TotalTime = 0.f;
+
+	NumOpened = 0;
+	NumClosed = 0;
+	NumPicked = 0;
+	NumDropped = 0;
+	LastDropTime = -1.f;
+	NumFailed = 0;
+
+	PhysicsStartSeconds = 0.0;
+	LastPhysicsTime = 0.f;
+	LastFrameSeconds = 0.0;
+	NumExpectedClients = 0;
+	NumSharedClients = 0;
+}
+
+bool AKitchenBenchmark::IsBenchmarkRequested()
+{
+	return FParse::Param(FCommandLine::Get(), TEXT("KitchenBenchmark"));
+}
+
+void AKitchenBenchmark::BeginPlay()
+{
+	Super::BeginPlay();
+
+	UWorld* World = GetWorld();
+
+	//Request all kitchen areas, they are loaded asynchronously while we wait
+	for (ULevelStreaming* StreamingLevel : World->StreamingLevels)
+	{
+		const FString LevelName = FPackageName::GetShortName(StreamingLevel->GetWorldAssetPackageName());
+		for (const FName& SublevelName : SublevelNames)
+		{
+			if (LevelName.EndsWith(SublevelName.ToString()))
+			{
+				StreamingLevel->bShouldBeLoaded = true;
+				StreamingLevel->bShouldBeVisible = true;
+			}
+		}
+	}
+
+	//Timestamps right before the simulation starts and right after it ends
+	PhysicsStartTick.Target = this;
+	PhysicsStartTick.bPhysicsStart = true;
+	PhysicsStartTick.bCanEverTick = true;
+	PhysicsStartTick.TickGroup = TG_StartPhysics;
+	PhysicsStartTick.RegisterTickFunction(GetLevel());
+	World->StartPhysicsTickFunction.AddPrerequisite(this, PhysicsStartTick);
+
+	PhysicsEndTick.Target = this;
+	PhysicsEndTick.bPhysicsStart = false;
+	PhysicsEndTick.bCanEverTick = true;
+	PhysicsEndTick.TickGroup = TG_EndPhysics;
+	PhysicsEndTick.RegisterTickFunction(GetLevel());
+	PhysicsEndTick.AddPrerequisite(World, World->EndPhysicsTickFunction);
+
+	FParse::Value(FCommandLine::Get(), TEXT("KitchenClients="), NumExpectedClients);
+
+	Character = AcquireCharacter();
+	if (Character)
+	{
+		Character->AddTickPrerequisiteActor(this);
+	}
+
+	SetPhase(EBenchmarkPhase::LoadingLevels);
+}
+
+void AKitchenBenchmark::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	UWorld* World = GetWorld();
+	if (World)
+	{
+		World->StartPhysicsTickFunction.RemovePrerequisite(this, PhysicsStartTick);
+	}
+	PhysicsStartTick.UnRegisterTickFunction();
+	PhysicsEndTick.UnRegisterTickFunction();
+
+	Super::EndPlay(EndPlayReason);
+}
+
+AMyCharacter* AKitchenBenchmark::AcquireCharacter()
+{
+	UWorld* World = GetWorld();
+
+	//Only a local player, the controllers of remote clients belong to their operators
+	APlayerController* PlayerController = GEngine->GetFirstLocalPlayerController(World);
+
+	AMyCharacter* Found = PlayerController ? Cast<AMyCharacter>(PlayerController->GetPawn()) : nullptr;
+	if (!Found)
+	{
+		for (TActorIterator<AMyCharacter> It(World); It; ++It)
+		{
+			Found = *It;
+			break;
+		}
+	}
+	if (!Found && World->GetAuthGameMode())
+	{
+		AActor* PlayerStart = World->GetAuthGameMode()->FindPlayerStart(PlayerController);
+		const FTransform SpawnTransform = PlayerStart ? PlayerStart->GetActorTransform() : FTransform::Identity;
+		FActorSpawnParameters SpawnParams;
+		SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn;
+		Found = World->SpawnActor<AMyCharacter>(AMyCharacter::StaticClass(), SpawnTransform, SpawnParams);
+	}
+
+	if (Found && PlayerController && Found->GetController() != PlayerController)
+	{
+		PlayerController->Possess(Found);
+	}
+	else if (Found && !PlayerController && !Found->GetController())
+	{
+		//A dedicated server has no player, the script drives a character of its own and aims its view itself
+		Found->SpawnDefaultController();
+		AAIController* AIController = Cast<AAIController>(Found->GetController());
+		if (AIController)
+		{
+			AIController->bSetControlRotationFromPawnOrientation = false;
+		}
+	}
+	return Found;
+}
+
+void AKitchenBenchmark::SpawnAgents()
+{
+	int32 NumAgents = 1;
+	FParse::Value(FCommandLine::Get(), TEXT("KitchenAgents="), NumAgents);
+
+	//Extra characters start on a ring around the scripted one
+	const FVector Center = Character->GetActorLocation();
+	for (int32 Index = 1; Index < NumAgents; Index++)
+	{
+		const float Angle = 2.f * PI * Index / NumAgents;
+		const FVector Location = Center + FVector(FMath::Cos(Angle), FMath::Sin(Angle), 0.f) * 150.f;
+		const FTransform SpawnTransform(FRotator(0.f, FMath::RadiansToDegrees(Angle), 0.f), Location);
+
+		AMyCharacter* Agent = GetWorld()->SpawnActorDeferred<AMyCharacter>(AMyCharacter::StaticClass(), SpawnTransform, nullptr, nullptr, ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn);
+		if (!Agent)
+		{
+			continue;
+		}
+		//Only the scripted character belongs to the player
+		Agent->AutoPossessPlayer = EAutoReceiveInput::Disabled;
+		Agent->FinishSpawning(SpawnTransform);
+		Agent->SpawnDefaultController();
+		Agents.Add(Agent);
+	}
+
+	UE_LOG(LogTemp, Log, TEXT("Kitchen benchmark: %d agents"), Agents.Num() + 1);
+}
+
+void AKitchenBenchmark::DriveAgents(float DeltaSeconds)
+{
+	for (int32 Index = 0; Index < Agents.Num(); Index++)
+	{
+		AMyCharacter* Agent = Agents[Index];
+		if (!Agent || !Agent->GetController())
+		{
+			continue;
+		}
+		//The AI controller follows the orientation of its pawn
+		FRotator Rotation = Agent->GetActorRotation();
+		Rotation.Yaw += (Index % 2 ? 30.f : -30.f) * DeltaSeconds;
+		Agent->SetActorRotation(Rotation);
+		Agent->GetController()->SetControlRotation(Rotation);
+		Agent->MoveForward(0.5f);
+	}
+}
+
+void AKitchenBenchmark::BuildTargets()
+{
+	Targets.Empty();
+
+	AInteractableRegistry* Registry = AInteractableRegistry::Get(GetWorld());
+	TArray<UInteractableComponent*> Found;
+
+	//Drawers and doors are opened through their handles
+	Registry->GetInteractables(EInteractableKind::Handle, Found);
+	Registry->GetInteractables(EInteractableKind::Item, Found);
+
+	//Same order on every run
+	Found.Sort([](const UInteractableComponent& A, const UInteractableComponent& B)
+	{
+		return A.GetOwner()->GetName() < B.GetOwner()->GetName();
+	});
+
+	int32 MaxTargets = Found.Num();
+	FParse::Value(FCommandLine::Get(), TEXT("BenchmarkMaxTargets="), MaxTargets);
+	for (int32 Index = 0; Index < Found.Num() && Index < MaxTargets; Index++)
+	{
+		Targets.Add(Found[Index]);
+	}
+
+	UE_LOG(LogTemp, Log, TEXT("Kitchen benchmark: %d targets"), Targets.Num());
+}
+
+void AKitchenBenchmark::Tick(float DeltaSeconds)
+{
+	Super::Tick(DeltaSeconds);
+
+	PhaseTime += DeltaSeconds;
+	if (Phase != EBenchmarkPhase::LoadingLevels && Phase != EBenchmarkPhase::Warmup && Phase != EBenchmarkPhase::Finished)
+	{
+		RecordFrame(DeltaSeconds);
+	}
+	LastFrameSeconds = FPlatformTime::Seconds();
+
+	if (!Character || !Character->GetController())
+	{
+		if (Phase != EBenchmarkPhase::Finished)
+		{
+			UE_LOG(LogTemp, Error, TEXT("Kitchen benchmark: no character to drive"));
+			Finish();
+		}
+		return;
+	}
+
+	if (Phase != EBenchmarkPhase::LoadingLevels && Phase != EBenchmarkPhase::Finished)
+	{
+		DriveAgents(DeltaSeconds);
+	}
+
+	UInteractableComponent* Target = Targets.IsValidIndex(TargetIndex) ? Targets[TargetIndex].Get() : nullptr;
+
+	switch (Phase)
+	{
+	case EBenchmarkPhase::LoadingLevels:
+	{
+		bool bAllVisible = true;
+		for (ULevelStreaming* StreamingLevel : GetWorld()->StreamingLevels)
+		{
+			if (StreamingLevel->bShouldBeVisible && !StreamingLevel->IsLevelVisible())
+			{
+				bAllVisible = false;
+			}
+		}
+		if (bAllVisible || PhaseTime > 120.f)
+		{
+			SpawnAgents();
+			SetPhase(EBenchmarkPhase::Warmup);
+		}
+		break;
+	}
+
+	case EBenchmarkPhase::Warmup:
+		//Clients joining are told to load the kitchen areas, the warmup starts once every client is there
+		if (GetNumClients() != NumSharedClients)
+		{
+			ShareStreamingWithClients();
+			NumSharedClients = GetNumClients();
+		}
+		if (NumSharedClients < NumExpectedClients)
+		{
+			PhaseTime = 0.f;
+		}
+		else if (PhaseTime > WarmupTime)
+		{
+			BuildTargets();
+			SetPhase(EBenchmarkPhase::LookAround);
+		}
+		break;
+
+	case EBenchmarkPhase::LookAround:
+	{
+		//Walk a little while turning a full circle
+		FRotator View = Character->GetController()->GetControlRotation();
+		View.Yaw += 90.f * DeltaSeconds;
+		View.Pitch = 0.f;
+		Character->GetController()->SetControlRotation(View);
+		Character->MoveForward(0.5f);
+		if (PhaseTime > 4.f)
+		{
+			NextTarget();
+		}
+		break;
+	}
+
+	case EBenchmarkPhase::Approach:
+	{
+		if (!Target)
+		{
+			NextTarget();
+			break;
+		}
+		const FVector TargetLocation = Target->GetMesh() ? Target->GetMesh()->Bounds.Origin : Target->GetOwner()->GetActorLocation();
+		FVector ToTarget = TargetLocation - Character->GetActorLocation();
+		ToTarget.Z = 0.f;
+
+		LookAt(TargetLocation);
+		if (ToTarget.Size() < 0.6f * Character->MaxGraspLength)
+		{
+			SetPhase(EBenchmarkPhase::Aim);
+		}
+		else if (PhaseTime > ApproachTimeout)
+		{
+			//Blocked by the furniture, stand in front of the target instead
+			const FVector Direction = ToTarget.GetSafeNormal();
+			Character->SetActorLocation(FVector(TargetLocation.X, TargetLocation.Y, Character->GetActorLocation().Z) - Direction * 0.6f * Character->MaxGraspLength, false, nullptr, ETeleportType::TeleportPhysics);
+			SetPhase(EBenchmarkPhase::Aim);
+		}
+		else
+		{
+			Character->MoveForward(1.f);
+		}
+		break;
+	}
+
+	case EBenchmarkPhase::Aim:
+	{
+		if (!Target)
+		{
+			NextTarget();
+			break;
+		}
+		LookAt(Target->GetMesh() ? Target->GetMesh()->Bounds.Origin : Target->GetOwner()->GetActorLocation());
+
+		//Wait for the focus trace to find the target, or give up after a second
+		const bool bFocused = Character->HighlightedActor == Target->GetOwner();
+		if (!bFocused && PhaseTime < 1.f)
+		{
+			break;
+		}
+		if (!bFocused)
+		{
+			NumFailed++;
+			NextTarget();
+			break;
+		}
+
+		if (Target->IsItem())
+		{
+			Character->Click();
+			if (!Character->GetSelectedHand()->IsEmpty())
+			{
+				NumPicked++;
+				SetPhase(EBenchmarkPhase::Carry);
+			}
+			else
+			{
+				NumFailed++;
+				NextTarget();
+			}
+		}
+		else
+		{
+			//The state is only known once the drawer stops, count the commands given to its drive
+			UInteractableComponent* Openable = Target->GetOpenTarget();
+			UOpenableDriveComponent* Drive = Openable ? Openable->GetDrive() : nullptr;
+			if (Drive && Drive->IsTargetOpen() && PhaseTime < 1.f)
+			{
+				//Give the drawer time to move before closing it
+				break;
+			}
+			const bool bWasOpen = Drive && Drive->IsTargetOpen();
+			Character->Click();
+			const bool bIsOpen = Drive && Drive->IsTargetOpen();
+
+			if (!Drive || bIsOpen == bWasOpen)
+			{
+				NumFailed++;
+				NextTarget();
+			}
+			else if (bIsOpen)
+			{
+				//Give the drawer time to move, then close it again
+				NumOpened++;
+				SetPhase(EBenchmarkPhase::Aim);
+			}
+			else
+			{
+				NumClosed++;
+				NextTarget();
+			}
+		}
+		break;
+	}
+
+	case EBenchmarkPhase::Carry:
+	{
+		//Look around and adjust the item in hand
+		FRotator View = Character->GetController()->GetControlRotation();
+		View.Yaw += 45.f * DeltaSeconds;
+		Character->GetController()->SetControlRotation(View);
+		Character->MoveItemZ(1.f);
+		if (PhaseTime > CarryTime)
+		{
+			SetPhase(EBenchmarkPhase::Drop);
+		}
+		break;
+	}
+
+	case EBenchmarkPhase::Drop:
+	{
+		//Look at the floor in front of the character, lower the longer the drop fails
+		const FVector Forward = Character->GetActorForwardVector();
+		LookAt(Character->GetActorLocation() + Forward * (60.f - 20.f * PhaseTime) - FVector(0.f, 0.f, 100.f));
+
+		//Leave a few frames for the focus trace to reach the new surface
+		if (PhaseTime < 0.2f)
+		{
+			break;
+		}
+		Character->Click();
+		if (Character->GetSelectedHand()->IsEmpty())
+		{
+			NumDropped++;
+			LastDropTime = TotalTime;
+			NextTarget();
+		}
+		else if (PhaseTime > 2.f)
+		{
+			//Keep the item and continue with the other hand
+			NumFailed++;
+			Character->SwitchSelectedHand();
+			NextTarget();
+		}
+		break;
+	}
+
+	case EBenchmarkPhase::Finished:
+		break;
+	}
+}
+
+void AKitchenBenchmark::LookAt(const FVector& Point)
+{
+	const FVector ViewLocation = Character->GetMyCharacterCamera()->GetComponentLocation();
+	Character->GetController()->SetControlRotation((Point - ViewLocation).Rotation());
+}
+
+void AKitchenBenchmark::SetPhase(EBenchmarkPhase NewPhase)
+{
+	Phase = NewPhase;
+	PhaseTime = 0.f;
+}
+
+void AKitchenBenchmark::NextTarget()
+{
+	TargetIndex++;
+	if (Targets.IsValidIndex(TargetIndex))
+	{
+		SetPhase(EBenchmarkPhase::Approach);
+	}
+	else
+	{
+		Finish();
+	}
+}
+
+void AKitchenBenchmark::OnPhysicsTimestamp(bool bPhysicsStart)
+{
+	if (bPhysicsStart)
+	{
+		PhysicsStartSeconds = FPlatformTime::Seconds();
+	}
+	else
+	{
+		LastPhysicsTime = (FPlatformTime::Seconds() - PhysicsStartSeconds) * 1000.0;
+	}
+}
+
+void AKitchenBenchmark::RecordFrame(float DeltaSeconds)
+{
+	TotalTime += DeltaSeconds;
+	FrameTimes.Add((FPlatformTime::Seconds() - LastFrameSeconds) * 1000.0);
+	GameThreadTimes.Add(FPlatformTime::ToMilliseconds(GGameThreadTime));
+
+	//With batched traces the work happens in the scheduler, shared by all characters
+	uint32 TraceCycles = Character ? Character->FocusTraceCycles : 0;
+	if (AFocusTraceScheduler* Scheduler = FindWorldManager<AFocusTraceScheduler>(GetWorld()))
+	{
+		TraceCycles += Scheduler->GetLastBatchCycles();
+	}
+	TraceTimes.Add(FPlatformTime::ToMilliseconds(TraceCycles));
+	PhysicsTimes.Add(LastPhysicsTime);
+	RecordNetTraffic();
+
+	if (LastDropTime >= 0.f && TotalTime - LastDropTime < 1.f)
+	{
+		DropFrameTimes.Add(FrameTimes.Last());
+		DropPhysicsTimes.Add(LastPhysicsTime);
+	}
+}
+
+int32 AKitchenBenchmark::GetNumClients() const
+{
+	const UNetDriver* NetDriver = GetWorld()->GetNetDriver();
+	return NetDriver && NetDriver->IsServer() ? NetDriver->ClientConnections.Num() : 0;
+}
+
+void AKitchenBenchmark::ShareStreamingWithClients()
+{
+	if (GetNumClients() == 0)
+	{
+		return;
+	}
+
+	for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+	{
+		APlayerController* PlayerController = *It;
+		if (!PlayerController || PlayerController->IsLocalController())
+		{
+			continue;
+		}
+		for (ULevelStreaming* StreamingLevel : GetWorld()->StreamingLevels)
+		{
+			if (StreamingLevel->bShouldBeVisible)
+			{
+				PlayerController->ClientUpdateLevelStreamingStatus(StreamingLevel->GetWorldAssetPackageFName(), true, true, false, INDEX_NONE);
+			}
+		}
+	}
+}
+
+void AKitchenBenchmark::RecordNetTraffic()
+{
+	const UNetDriver* NetDriver = GetWorld()->GetNetDriver();
+	if (!NetDriver || !NetDriver->IsServer())
+	{
+		return;
+	}
+
+	//The connections update their rate once per stat period, the mean over the frames is the mean rate
+	for (const UNetConnection* Connection : NetDriver->ClientConnections)
+	{
+		if (Connection)
+		{
+			ClientBytesPerSecond.FindOrAdd(Connection->LowLevelGetRemoteAddress(true)).Add(Connection->OutBytesPerSecond);
+		}
+	}
+}
+
+float AKitchenBenchmark::Percentile(TArray<float> Samples, float Fraction)
+{
+	if (Samples.Num() == 0)
+	{
+		return 0.f;
+	}
+	Samples.Sort();
+	const int32 Index = FMath::Clamp(FMath::CeilToInt(Fraction * Samples.Num()) - 1, 0, Samples.Num() - 1);
+	return Samples[Index];
+}
+
+static float Mean(const TArray<float>& Samples)
+{
+	float Sum = 0.f;
+	for (const float Sample : Samples)
+	{
+		Sum += Sample;
+	}
+	return Samples.Num() ? Sum / Samples.Num() : 0.f;
+}
+
+void AKitchenBenchmark::Finish()
+{
+	SetPhase(EBenchmarkPhase::Finished);
+
+	FString Csv = TEXT("Metric,Value\n");
+	static const IConsoleVariable* TraceModeVar = IConsoleManager::Get().FindConsoleVariable(TEXT("Kitchen.FocusTraceMode"));
+	Csv += FString::Printf(TEXT("Agents,%d\n"), Agents.Num() + 1);
+	Csv += FString::Printf(TEXT("FocusTraceMode,%d\n"), TraceModeVar ? TraceModeVar->GetInt() : 0);
+	Csv += FString::Printf(TEXT("Frames,%d\n"), FrameTimes.Num());
+	Csv += FString::Printf(TEXT("Duration (s),%.3f\n"), TotalTime);
+	Csv += FString::Printf(TEXT("FrameTime Mean (ms),%.3f\n"), Mean(FrameTimes));
+	Csv += FString::Printf(TEXT("FrameTime P50 (ms),%.3f\n"), Percentile(FrameTimes, 0.5f));
+	Csv += FString::Printf(TEXT("FrameTime P90 (ms),%.3f\n"), Percentile(FrameTimes, 0.9f));
+	Csv += FString::Printf(TEXT("FrameTime P95 (ms),%.3f\n"), Percentile(FrameTimes, 0.95f));
+	Csv += FString::Printf(TEXT("FrameTime P99 (ms),%.3f\n"), Percentile(FrameTimes, 0.99f));
+	Csv += FString::Printf(TEXT("FrameTime Max (ms),%.3f\n"), Percentile(FrameTimes, 1.f));
+	Csv += FString::Printf(TEXT("GameThread Mean (ms),%.3f\n"), Mean(GameThreadTimes));
+	Csv += FString::Printf(TEXT("GameThread P95 (ms),%.3f\n"), Percentile(GameThreadTimes, 0.95f));
+	Csv += FString::Printf(TEXT("Trace Mean (ms),%.4f\n"), Mean(TraceTimes));
+	Csv += FString::Printf(TEXT("Trace P95 (ms),%.4f\n"), Percentile(TraceTimes, 0.95f));
+	Csv += FString::Printf(TEXT("Physics Mean (ms),%.3f\n"), Mean(PhysicsTimes));
+	Csv += FString::Printf(TEXT("Physics P95 (ms),%.3f\n"), Percentile(PhysicsTimes, 0.95f));
+	Csv += FString::Printf(TEXT("Drop FrameTime P95 (ms),%.3f\n"), Percentile(DropFrameTimes, 0.95f));
+	Csv += FString::Printf(TEXT("Drop FrameTime Max (ms),%.3f\n"), Percentile(DropFrameTimes, 1.f));
+	Csv += FString::Printf(TEXT("Drop Physics P95 (ms),%.3f\n"), Percentile(DropPhysicsTimes, 0.95f));
+	Csv += FString::Printf(TEXT("Drop Physics Max (ms),%.3f\n"), Percentile(DropPhysicsTimes, 1.f));
+	Csv += FString::Printf(TEXT("Targets,%d\n"), Targets.Num());
+	Csv += FString::Printf(TEXT("Opened,%d\n"), NumOpened);
+	Csv += FString::Printf(TEXT("Closed,%d\n"), NumClosed);
+	Csv += FString::Printf(TEXT("Picked,%d\n"), NumPicked);
+	Csv += FString::Printf(TEXT("Dropped,%d\n"), NumDropped);
+	Csv += FString::Printf(TEXT("Failed,%d\n"), NumFailed);
+	Csv += FString::Printf(TEXT("Clients,%d\n"), ClientBytesPerSecond.Num());
+	int32 ClientIndex = 0;
+	for (const auto& Client : ClientBytesPerSecond)
+	{
+		Csv += FString::Printf(TEXT("Client %d Address,%s\n"), ClientIndex, *Client.Key);
+		Csv += FString::Printf(TEXT("Client %d Sent Mean (B/s),%.0f\n"), ClientIndex, Mean(Client.Value));
+		Csv += FString::Printf(TEXT("Client %d Sent P95 (B/s),%.0f\n"), ClientIndex, Percentile(Client.Value, 0.95f));
+		Csv += FString::Printf(TEXT("Client %d Sent Max (B/s),%.0f\n"), ClientIndex, Percentile(Client.Value, 1.f));
+		ClientIndex++;
+	}
+
+	FString CsvPath;
+	if (!FParse::Value(FCommandLine::Get(), TEXT("BenchmarkCsv="), CsvPath))
+	{
+		CsvPath = FPaths::GameSavedDir() / TEXT("Benchmark") / FString::Printf(TEXT("KitchenBenchmark-%s.csv"), *FDateTime::Now().ToString());
+	}
+
+	if (FFileHelper::SaveStringToFile(Csv, *CsvPath))
+	{
+		UE_LOG(LogTemp, Log, TEXT("Kitchen benchmark results written to %s"), *CsvPath);
+	}
+	else
+	{
+		UE_LOG(LogTemp, Error, TEXT("Kitchen benchmark could not write %s"), *CsvPath);
+	}
+
+	FPlatformMisc::RequestExit(false);
+}
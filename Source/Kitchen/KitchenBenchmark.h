@@ -0,0 +1,187 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "GameFramework/Actor.h"
+#include "KitchenBenchmark.generated.h"
+
+class AMyCharacter;
+class UInteractableComponent;
+
+//Tick function used to timestamp the start and the end of the physics simulation
+USTRUCT()
+struct FKitchenPhysicsTimerTickFunction : public FTickFunction
+{
+	GENERATED_USTRUCT_BODY()
+
+	//Benchmark receiving the timestamps
+	class AKitchenBenchmark* Target;
+
+	//True for the tick placed before the simulation starts, false for the one after it ends
+	bool bPhysicsStart;
+
+	virtual void ExecuteTick(float DeltaTime, ELevelTick TickType, ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent) override;
+	virtual FString DiagnosticMessage() override;
+};
+
+template<>
+struct TStructOpsTypeTraits<FKitchenPhysicsTimerTickFunction> : public TStructOpsTypeTraitsBase
+{
+	enum
+	{
+		WithCopy = false
+	};
+};
+
+//Steps of the scripted walkthrough
+enum class EBenchmarkPhase : uint8
+{
+	LoadingLevels,
+	Warmup,
+	LookAround,
+	Approach,
+	Aim,
+	Carry,
+	Drop,
+	Finished
+};
+
+/**
+ * Scripted walkthrough of the kitchen used as a repeatable performance benchmark.
+ * Spawned by the game mode when the game is started with -KitchenBenchmark; it loads the kitchen
+ * sublevels, drives the player character through its input handlers (walk, look, open every
+ * drawer and door, pick and drop every item) and writes the measured frame times to a CSV file
+ * before quitting. Runs headless with -nullrhi -unattended. With -KitchenAgents=N, N-1 extra characters
+ * wander around the kitchen during the walkthrough so the cost of many agents can be measured.
+ * On a server started with -KitchenClients=N the walkthrough waits for N clients and the bytes per
+ * second sent to each of them are added to the results; a dedicated server drives a character of its own.
+ */
+UCLASS(config = Game)
+class KITCHEN_API AKitchenBenchmark : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	AKitchenBenchmark();
+
+	// Called when the game starts or when spawned
+	virtual void BeginPlay() override;
+
+	// Called when the game ends or when destroyed
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	// Called every frame
+	virtual void Tick(float DeltaSeconds) override;
+
+	//Returns true if the game was started in benchmark mode
+	static bool IsBenchmarkRequested();
+
+	//Returns the value below which the given fraction of the samples falls, also used by the replay
+	static float Percentile(TArray<float> Samples, float Fraction);
+
+	//Called by the physics timer tick functions
+	void OnPhysicsTimestamp(bool bPhysicsStart);
+
+	//Streaming levels loaded before the walkthrough starts
+	UPROPERTY(config)
+	TArray<FName> SublevelNames;
+
+	//Seconds spent before recording, so loading hitches are not measured
+	UPROPERTY(config)
+	float WarmupTime;
+
+	//Maximum seconds spent walking towards a target before being placed next to it
+	UPROPERTY(config)
+	float ApproachTimeout;
+
+	//Seconds an item is carried around before being dropped
+	UPROPERTY(config)
+	float CarryTime;
+
+protected:
+	//Possesses the character driven by the script, spawning one if the player has none
+	AMyCharacter* AcquireCharacter();
+
+	//Spawns the extra characters requested on the command line
+	void SpawnAgents();
+
+	//Turns and walks the extra characters around the kitchen
+	void DriveAgents(float DeltaSeconds);
+
+	//Fills the list of targets with the handles and items of the registry
+	void BuildTargets();
+
+	//Turns the view of the character towards a point
+	void LookAt(const FVector& Point);
+
+	//Moves the script to the next phase and restarts the phase timer
+	void SetPhase(EBenchmarkPhase NewPhase);
+
+	//Goes to the next target or finishes the walkthrough
+	void NextTarget();
+
+	//Records the measurements of the last frame
+	void RecordFrame(float DeltaSeconds);
+
+	//Returns the number of clients connected to this server
+	int32 GetNumClients() const;
+
+	//Makes the clients load the sublevels the benchmark loaded
+	void ShareStreamingWithClients();
+
+	//Samples the bytes per second sent to each client
+	void RecordNetTraffic();
+
+	//Writes the results and quits the game
+	void Finish();
+
+	//Character driven by the script
+	UPROPERTY()
+	AMyCharacter* Character;
+
+	//Extra characters wandering around while the script runs
+	UPROPERTY()
+	TArray<AMyCharacter*> Agents;
+
+	//Handles and items visited, in a stable order
+	TArray<TWeakObjectPtr<UInteractableComponent>> Targets;
+	int32 TargetIndex;
+
+	EBenchmarkPhase Phase;
+	float PhaseTime;
+	float TotalTime;
+
+	//Per frame measurements, in milliseconds
+	TArray<float> FrameTimes;
+	TArray<float> GameThreadTimes;
+	TArray<float> TraceTimes;
+	TArray<float> PhysicsTimes;
+
+	//Bytes per second sent to each client, sampled every frame and keyed by the client address
+	TMap<FString, TArray<float>> ClientBytesPerSecond;
+
+	//Clients the walkthrough waits for before it starts, and clients told which areas to load
+	int32 NumExpectedClients;
+	int32 NumSharedClients;
+
+	//Measurements of the second following each drop, where depenetration spikes show
+	TArray<float> DropFrameTimes;
+	TArray<float> DropPhysicsTimes;
+	float LastDropTime;
+
+	//Interactions performed by the script
+	int32 NumOpened;
+	int32 NumClosed;
+	int32 NumPicked;
+	int32 NumDropped;
+	int32 NumFailed;
+
+	//Timestamps taken around the physics simulation
+	FKitchenPhysicsTimerTickFunction PhysicsStartTick;
+	FKitchenPhysicsTimerTickFunction PhysicsEndTick;
+	double PhysicsStartSeconds;
+	float LastPhysicsTime;
+
+	//Wall clock time of the previous frame
+	double LastFrameSeconds;
+};
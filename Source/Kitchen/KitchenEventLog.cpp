@@ -0,0 +1,273 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Kitchen.h"
+#include "KitchenEventLog.h"
+#include "HAL/RunnableThread.h"
+
+static TAutoConsoleVariable<int32> CVarEventLog(
+	TEXT("Kitchen.EventLog"),
+	1,
+	TEXT("0: interactions are not logged\n")
+	TEXT("1: interactions are written as text to Saved/Logs/KitchenEvents.log\n")
+	TEXT("2: interactions are written as JSON lines to Saved/Logs/KitchenEvents.jsonl"),
+	ECVF_Default);
+
+//Enum the value of an event belongs to
+enum class EEventValue : uint8
+{
+	None,
+	ItemType,
+	AssetState,
+	Integer
+};
+
+struct FEventDescription
+{
+	const TCHAR* Name;
+	EEventValue Value;
+};
+
+//Indexed by EKitchenEvent
+static const FEventDescription EventDescriptions[] =
+{
+	{ TEXT("Pick"), EEventValue::ItemType },
+	{ TEXT("Drop"), EEventValue::ItemType },
+	{ TEXT("DropRefused"), EEventValue::ItemType },
+	{ TEXT("Open"), EEventValue::AssetState },
+	{ TEXT("Close"), EEventValue::AssetState },
+	{ TEXT("SwitchHand"), EEventValue::None },
+	{ TEXT("RotationAxis"), EEventValue::Integer },
+	{ TEXT("InvalidClick"), EEventValue::None },
+	{ TEXT("DrawerStopped"), EEventValue::AssetState }
+};
+static_assert(ARRAY_COUNT(EventDescriptions) == static_cast<int32>(EKitchenEvent::Count), "EKitchenEvent changed, update its descriptions");
+
+//Records logged by one thread; only that thread moves Head and only the writer moves Tail
+struct FEventRing
+{
+	static const int32 Capacity = 1024;
+
+	FKitchenEventRecord Records[Capacity];
+	FThreadSafeCounter Head;
+	FThreadSafeCounter Tail;
+};
+
+//Drains the rings of all threads and writes the records to disk
+class FEventLogWriter : public FRunnable
+{
+public:
+	FEventLogWriter()
+		: File(nullptr)
+		, Format(0)
+		, Thread(nullptr)
+	{
+		Thread = FRunnableThread::Create(this, TEXT("KitchenEventLogWriter"), 0, TPri_Lowest);
+	}
+
+	virtual ~FEventLogWriter()
+	{
+		bStopping = true;
+		if (Thread)
+		{
+			Thread->WaitForCompletion();
+			delete Thread;
+		}
+		delete File;
+
+		for (FEventRing* Ring : Rings)
+		{
+			delete Ring;
+		}
+	}
+
+	//Adds the ring of a thread logging for the first time
+	void AddRing(FEventRing* Ring)
+	{
+		FScopeLock Lock(&RingsLock);
+		Rings.Add(Ring);
+	}
+
+	virtual uint32 Run() override
+	{
+		while (!bStopping)
+		{
+			FPlatformProcess::Sleep(0.05f);
+			Drain();
+		}
+		Drain();
+		if (File)
+		{
+			File->Flush();
+		}
+		return 0;
+	}
+
+	FThreadSafeCounter NumDropped;
+
+private:
+	void Drain()
+	{
+		{
+			FScopeLock Lock(&RingsLock);
+			DrainedRings = Rings;
+		}
+
+		for (FEventRing* Ring : DrainedRings)
+		{
+			const int32 Tail = Ring->Tail.GetValue();
+			const int32 Head = Ring->Head.GetValue();
+			for (int32 Index = Tail; Index != Head; Index++)
+			{
+				Write(Ring->Records[Index & (FEventRing::Capacity - 1)]);
+			}
+
+			//The slots can be reused by the thread from now on
+			Ring->Tail.Set(Head);
+		}
+
+		const int32 Dropped = NumDropped.Set(0);
+		if (Dropped > 0 && OpenFile())
+		{
+			WriteLine(Format == 2
+				? FString::Printf(TEXT("{\"event\":\"Dropped\",\"count\":%d}"), Dropped)
+				: FString::Printf(TEXT("%d events dropped, the log rings were full"), Dropped));
+		}
+	}
+
+	//Opens the file on the first record, in the format asked for at that time
+	bool OpenFile()
+	{
+		if (!File)
+		{
+			Format = CVarEventLog.GetValueOnAnyThread() == 2 ? 2 : 1;
+			FString Directory;
+			if (!FParse::Value(FCommandLine::Get(), TEXT("KitchenEventDir="), Directory))
+			{
+				Directory = FPaths::GameLogDir();
+			}
+			const FString FilePath = Directory / (Format == 2 ? TEXT("KitchenEvents.jsonl") : TEXT("KitchenEvents.log"));
+			File = IFileManager::Get().CreateFileWriter(*FilePath, FILEWRITE_AllowRead);
+		}
+		return File != nullptr;
+	}
+
+	void Write(const FKitchenEventRecord& Record)
+	{
+		if (!OpenFile())
+		{
+			return;
+		}
+
+		const FEventDescription& Description = EventDescriptions[static_cast<int32>(Record.Event)];
+		FString Value;
+		switch (Description.Value)
+		{
+		case EEventValue::ItemType:
+			Value = GetEnumName(static_cast<EItemType>(Record.Value));
+			break;
+		case EEventValue::AssetState:
+			Value = GetEnumName(static_cast<EAssetState>(Record.Value));
+			break;
+		case EEventValue::Integer:
+			Value = FString::FromInt(Record.Value);
+			break;
+		default:
+			break;
+		}
+		const TCHAR* Hand = Record.Hand > 0 ? TEXT("Right") : Record.Hand < 0 ? TEXT("Left") : TEXT("");
+
+		if (Format == 2)
+		{
+			WriteLine(FString::Printf(TEXT("{\"time\":%.4f,\"frame\":%llu,\"event\":\"%s\",\"actor\":\"%s\",\"target\":\"%s\",\"hand\":\"%s\",\"value\":\"%s\",\"amount\":%.3f}"),
+				Record.Time, Record.Frame, Description.Name, *Record.Actor.ToString(), *Record.Target.ToString(), Hand, *Value, Record.Amount));
+		}
+		else
+		{
+			WriteLine(FString::Printf(TEXT("[%.4f][%llu] %s %s %s %s %s %.3f"),
+				Record.Time, Record.Frame, Description.Name, *Record.Actor.ToString(), *Record.Target.ToString(), Hand, *Value, Record.Amount));
+		}
+	}
+
+	void WriteLine(const FString& Line)
+	{
+		FTCHARToUTF8 Converted(*Line);
+		File->Serialize(const_cast<ANSICHAR*>(Converted.Get()), Converted.Length());
+		File->Serialize(const_cast<ANSICHAR*>("\n"), 1);
+	}
+
+	FArchive* File;
+	int32 Format;
+	FRunnableThread* Thread;
+	FThreadSafeBool bStopping;
+
+	FCriticalSection RingsLock;
+	TArray<FEventRing*> Rings;
+
+	//Copy of the ring list, so the lock is not held while writing
+	TArray<FEventRing*> DrainedRings;
+};
+
+static FEventLogWriter* Writer = nullptr;
+static uint32 RingTlsSlot = 0;
+
+void FKitchenEventLog::Startup()
+{
+	if (!Writer && FPlatformProcess::SupportsMultithreading())
+	{
+		RingTlsSlot = FPlatformTLS::AllocTlsSlot();
+		Writer = new FEventLogWriter();
+	}
+}
+
+void FKitchenEventLog::Shutdown()
+{
+	if (Writer)
+	{
+		FEventLogWriter* StoppingWriter = Writer;
+		Writer = nullptr;
+		delete StoppingWriter;
+		FPlatformTLS::FreeTlsSlot(RingTlsSlot);
+	}
+}
+
+void FKitchenEventLog::Log(EKitchenEvent Event, const AActor* Actor, const AActor* Target, int8 Hand, int32 Value, float Amount)
+{
+	if (!Writer || CVarEventLog.GetValueOnAnyThread() == 0)
+	{
+		return;
+	}
+
+	//The only allocation, once per logging thread
+	FEventRing* Ring = static_cast<FEventRing*>(FPlatformTLS::GetTlsValue(RingTlsSlot));
+	if (!Ring)
+	{
+		Ring = new FEventRing();
+		FPlatformTLS::SetTlsValue(RingTlsSlot, Ring);
+		Writer->AddRing(Ring);
+	}
+
+	const int32 Head = Ring->Head.GetValue();
+	if (Head - Ring->Tail.GetValue() >= FEventRing::Capacity)
+	{
+		Writer->NumDropped.Increment();
+		return;
+	}
+
+	FKitchenEventRecord& Record = Ring->Records[Head & (FEventRing::Capacity - 1)];
+	Record.Time = FPlatformTime::Seconds() - GStartTime;
+	Record.Frame = GFrameCounter;
+	Record.Actor = Actor ? Actor->GetFName() : NAME_None;
+	Record.Target = Target ? Target->GetFName() : NAME_None;
+	Record.Event = Event;
+	Record.Hand = Hand;
+	Record.Value = Value;
+	Record.Amount = Amount;
+
+	//Publishes the record to the writer
+	Ring->Head.Set(Head + 1);
+}
+
+const TCHAR* FKitchenEventLog::GetEventName(EKitchenEvent Event)
+{
+	return Event < EKitchenEvent::Count ? EventDescriptions[static_cast<int32>(Event)].Name : TEXT("Invalid");
+}
@@ -0,0 +1,66 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "KitchenTypes.h"
+
+//Interactions written to the event log
+enum class EKitchenEvent : uint8
+{
+	Pick,
+	Drop,
+	DropRefused,
+	Open,
+	Close,
+	SwitchHand,
+	RotationAxis,
+	InvalidClick,
+	DrawerStopped,
+	Count
+};
+
+//One entry of the event log: plain data, copied into the buffer of the logging thread
+struct FKitchenEventRecord
+{
+	double Time;
+	uint64 Frame;
+
+	//Names are copied as FName indices, they are only turned into text by the writer thread
+	FName Actor;
+	FName Target;
+
+	EKitchenEvent Event;
+
+	//1 for the right hand, -1 for the left one, 0 when no hand is involved
+	int8 Hand;
+
+	//Enum value attached to the event, as an integer: EItemType for items, EAssetState for drawers, the rotation axis
+	int32 Value;
+
+	//Open fraction of a drawer, 0 otherwise
+	float Amount;
+};
+
+/**
+ * Structured log of the interactions, cheap enough to stay enabled in shipped builds.
+ * Log() copies a fixed size record into a ring owned by the calling thread: no lock, no allocation,
+ * no formatting. A writer thread drains the rings every few milliseconds and writes the records
+ * as text or as JSON lines to Saved/Logs/KitchenEvents, depending on Kitchen.EventLog, or to the
+ * directory given with -KitchenEventDir=<dir> so concurrent games do not share the file.
+ * Records logged while a ring is full are dropped and counted, the game never waits for the writer.
+ */
+class KITCHEN_API FKitchenEventLog
+{
+public:
+	//Starts the writer thread; called when the module starts
+	static void Startup();
+
+	//Writes what is left and stops the writer thread; called when the module shuts down
+	static void Shutdown();
+
+	//Records an interaction; Value is written with the names of the enum the event uses
+	static void Log(EKitchenEvent Event, const AActor* Actor, const AActor* Target, int8 Hand = 0, int32 Value = 0, float Amount = 0.f);
+
+	//Name of an event, from a table built at compile time
+	static const TCHAR* GetEventName(EKitchenEvent Event);
+};
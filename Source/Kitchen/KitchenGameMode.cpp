@@ -4,6 +4,13 @@
 #include "KitchenGameMode.h"
 #include "MyCharacter.h"
 #include "KitchenHUD.h"
+#include "KitchenBenchmark.h"
+#include "KitchenStreamingManager.h"
+#include "InteractionRecorder.h"
+#include "KitchenReplay.h"
+#include "WorldSnapshotService.h"
+#include "KitchenSaveGame.h"
+#include "FixedStepSimulation.h"
 
 AKitchenGameMode::AKitchenGameMode()
 	:Super()
@@ -15,5 +22,66 @@ AKitchenGameMode::AKitchenGameMode()
 	//HUDClass = AKitchenHUD::StaticClass();
 }
 
+void AKitchenGameMode::StartPlay()
+{
+	//Binary recording of the session, spawned first so the characters find it when they begin play
+	if (AInteractionRecorder::IsRecordingRequested())
+	{
+		GetWorld()->SpawnActor<AInteractionRecorder>();
+	}
+
+	Super::StartPlay();
+
+	//Scripted walkthrough used for the performance regression runs
+	if (AKitchenBenchmark::IsBenchmarkRequested())
+	{
+		GetWorld()->SpawnActor<AKitchenBenchmark>();
+	}
+	//The benchmark loads every area itself
+	else
+	{
+		AKitchenStreamingManager::Get(GetWorld());
+	}
+
+	//Prepared scenario, loaded once every actor has begun play
+	FString ScenarioSlot;
+	if (UKitchenSaveGame::IsScenarioRequested(ScenarioSlot))
+	{
+		UKitchenSaveGame::LoadScenario(GetWorld(), ScenarioSlot);
+	}
+
+	//Recorded session played again, streamed like it was recorded; it steps the engine by the recorded frame times
+	if (AKitchenReplay::IsReplayRequested())
+	{
+		GetWorld()->SpawnActor<AKitchenReplay>();
+	}
+	//Constant time step, as fast as the machine allows, for generating episodes
+	else if (AFixedStepSimulation::IsFixedStepRequested())
+	{
+		GetWorld()->SpawnActor<AFixedStepSimulation>();
+	}
+
+	//State of the kitchen published for external tools
+	if (AWorldSnapshotService::IsSnapshotRequested())
+	{
+		GetWorld()->SpawnActor<AWorldSnapshotService>();
+	}
 
+	//Episodes of the episode runner end after a fixed game time, which is the simulated time in fixed step mode
+	float Duration;
+	if (IsDurationRequested(Duration))
+	{
+		GetWorldTimerManager().SetTimer(EpisodeTimerHandle, this, &AKitchenGameMode::EndEpisode, Duration, false);
+	}
+}
+
+bool AKitchenGameMode::IsDurationRequested(float& OutSeconds)
+{
+	return FParse::Value(FCommandLine::Get(), TEXT("KitchenDuration="), OutSeconds) && OutSeconds > 0.f;
+}
 
+void AKitchenGameMode::EndEpisode()
+{
+	UE_LOG(LogTemp, Log, TEXT("Episode ended after %.2f s of game time"), GetWorld()->GetTimeSeconds());
+	FPlatformMisc::RequestExit(false);
+}
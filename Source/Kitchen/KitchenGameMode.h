@@ -15,4 +15,16 @@ class KITCHEN_API AKitchenGameMode : public AGameMode
 	
 public:
 	AKitchenGameMode();	
+
+	//Starts the match and the streaming of the kitchen areas, or the benchmark walkthrough when requested on the command line
+	virtual void StartPlay() override;
+
+	//Returns true and the game time an episode lasts if the game was started with -KitchenDuration=<seconds>
+	static bool IsDurationRequested(float& OutSeconds);
+
+private:
+	//Quits the game once the requested duration has been played
+	void EndEpisode();
+
+	FTimerHandle EpisodeTimerHandle;
 };
@@ -14,8 +14,16 @@ AKitchenHUD::AKitchenHUD()
 
 void AKitchenHUD::DrawHUD()
 {
+	SCOPE_CYCLE_COUNTER(STAT_KitchenDrawHUD);
+
 	Super::DrawHUD();
 
+	//Nothing to draw on when running headless (-nullrhi)
+	if (!Canvas || !CrosshairTex || !CrosshairTex->Resource)
+	{
+		return;
+	}
+
 	//Draw a simple crosshair
 
 	//Find the center of the Canvas
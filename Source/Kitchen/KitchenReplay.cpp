@@ -0,0 +1,368 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Kitchen.h"
+#include "KitchenReplay.h"
+#include "KitchenBenchmark.h"
+#include "MyCharacter.h"
+#include "InteractableRegistry.h"
+#include "InteractableComponent.h"
+
+using namespace KitchenRecording;
+
+AKitchenReplay::AKitchenReplay()
+{
+	//The recorded input is applied before the character ticks, like the input of a player controller would
+	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.TickGroup = TG_PrePhysics;
+
+	FixedDeltaTime = 0.f;
+	LocationTolerance = 1.f;
+	RotationTolerance = 2.f;
+
+	ReadOffset = 0;
+	bPlayerAssigned = false;
+	NumFrames = 0;
+	NumEvents = 0;
+	RecordedTime = 0.f;
+	StartSeconds = 0.0;
+	LastFrameSeconds = 0.0;
+	bFinished = false;
+}
+
+bool AKitchenReplay::IsReplayRequested()
+{
+	FString Unused;
+	return FParse::Value(FCommandLine::Get(), TEXT("KitchenReplay="), Unused);
+}
+
+void AKitchenReplay::BeginPlay()
+{
+	Super::BeginPlay();
+
+	FString FilePath;
+	FParse::Value(FCommandLine::Get(), TEXT("KitchenReplay="), FilePath);
+
+	const bool bLoaded = FFileHelper::LoadFileToArray(Recording, *FilePath);
+	FReader Reader(Recording);
+	if (!bLoaded || !Reader.ReadHeader())
+	{
+		UE_LOG(LogTemp, Error, TEXT("Kitchen replay could not read %s"), *FilePath);
+		bFinished = true;
+		FPlatformMisc::RequestExit(false);
+		return;
+	}
+	ReadOffset = Reader.Offset;
+	UE_LOG(LogTemp, Log, TEXT("Kitchen replay playing %s (%d bytes)"), *FilePath, Recording.Num());
+
+	//The engine steps by the recorded frame time instead of waiting for the wall clock; the step
+	//takes effect on the next engine frame, which replays the first recorded frame
+	const float FirstDeltaTime = PeekFrameDeltaTime(ReadOffset);
+	FApp::SetUseFixedTimeStep(true);
+	FApp::SetFixedDeltaTime(FixedDeltaTime > 0.f ? FixedDeltaTime : FirstDeltaTime > 0.f ? FirstDeltaTime : 1.f / 60.f);
+
+	StartSeconds = FPlatformTime::Seconds();
+	LastFrameSeconds = StartSeconds;
+}
+
+void AKitchenReplay::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	FApp::SetUseFixedTimeStep(false);
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void AKitchenReplay::Tick(float DeltaSeconds)
+{
+	Super::Tick(DeltaSeconds);
+
+	if (bFinished)
+	{
+		return;
+	}
+
+	const double NowSeconds = FPlatformTime::Seconds();
+	if (NumFrames > 0)
+	{
+		FrameTimes.Add(static_cast<float>((NowSeconds - LastFrameSeconds) * 1000.0));
+	}
+	LastFrameSeconds = NowSeconds;
+
+	if (!ReplayFrame())
+	{
+		Finish();
+	}
+}
+
+bool AKitchenReplay::ReplayFrame()
+{
+	FReader Reader(Recording);
+	Reader.Offset = ReadOffset;
+
+	while (!Reader.AtEnd())
+	{
+		const ERecordType Type = static_cast<ERecordType>(Reader.ReadByte());
+		switch (Type)
+		{
+		case ERecordType::Name:
+		{
+			const uint32 Id = static_cast<uint32>(Reader.ReadVarUInt());
+			ActorNames.Add(Id, Reader.ReadString());
+			break;
+		}
+		case ERecordType::Frame:
+		{
+			Reader.ReadVarUInt();
+			RecordedTime += Reader.ReadVarUInt() / 1000000.f;
+			NumFrames++;
+
+			//The step set now is used by the next engine frame, so it is the time the next recorded frame took
+			const float NextDeltaTime = PeekFrameDeltaTime(Reader.Offset);
+			if (FixedDeltaTime <= 0.f && NextDeltaTime > 0.f)
+			{
+				FApp::SetFixedDeltaTime(NextDeltaTime);
+			}
+			ReadOffset = Reader.Offset;
+			return !Reader.bError;
+		}
+		case ERecordType::Event:
+		{
+			//Events are the outcome of the input, replaying the input reproduces them
+			Reader.ReadByte();
+			Reader.ReadVarUInt();
+			Reader.ReadVarUInt();
+			Reader.ReadVarInt();
+			NumEvents++;
+			break;
+		}
+		case ERecordType::Transform:
+		{
+			const uint32 Id = static_cast<uint32>(Reader.ReadVarUInt());
+			const uint32 Mask = static_cast<uint32>(Reader.ReadVarUInt());
+			FQuantizedTransform& Transform = RecordedTransforms.FindOrAdd(Id);
+			for (int32 Component = 0; Component < NumTransformComponents; Component++)
+			{
+				if (Mask & (1 << Component))
+				{
+					Transform.Values[Component] += static_cast<int32>(Reader.ReadVarInt());
+				}
+			}
+			break;
+		}
+		case ERecordType::Input:
+		{
+			ApplyInput(Reader);
+			break;
+		}
+		case ERecordType::State:
+		{
+			const uint32 Id = static_cast<uint32>(Reader.ReadVarUInt());
+			RecordedStates.Add(Id, Reader.ReadByte());
+			break;
+		}
+		default:
+		{
+			UE_LOG(LogTemp, Error, TEXT("Kitchen replay found an unknown record %d at offset %d"), static_cast<int32>(Type), Reader.Offset - 1);
+			Reader.bError = true;
+			break;
+		}
+		}
+	}
+
+	ReadOffset = Reader.Offset;
+	return false;
+}
+
+float AKitchenReplay::PeekFrameDeltaTime(int32 Offset) const
+{
+	FReader Reader(Recording);
+	Reader.Offset = Offset;
+	while (!Reader.AtEnd())
+	{
+		const ERecordType Type = static_cast<ERecordType>(Reader.ReadByte());
+		if (Type == ERecordType::Frame)
+		{
+			Reader.ReadVarUInt();
+			const float DeltaTime = Reader.ReadVarUInt() / 1000000.f;
+			return Reader.bError ? 0.f : DeltaTime;
+		}
+		Reader.SkipRecord(Type);
+	}
+	return 0.f;
+}
+
+void AKitchenReplay::ApplyInput(FReader& Reader)
+{
+	const uint32 Id = static_cast<uint32>(Reader.ReadVarUInt());
+	const uint8 Actions = Reader.ReadByte();
+	const uint32 Mask = static_cast<uint32>(Reader.ReadVarUInt());
+
+	float Axes[NumInputAxes];
+	for (int32 Axis = 0; Axis < NumInputAxes; Axis++)
+	{
+		Axes[Axis] = (Mask & (1 << Axis)) ? Reader.ReadVarInt() / InputScale : 0.f;
+	}
+
+	AMyCharacter* Character = ResolveCharacter(Id);
+	FReplayedCharacter& Replayed = Characters.FindOrAdd(Id);
+	for (int32 Component = 0; Component < 3; Component++)
+	{
+		if (Mask & (1 << (ControlRotationBit + Component)))
+		{
+			Replayed.ControlRotation[Component] = static_cast<int32>(Reader.ReadVarInt());
+		}
+	}
+	if (!Character || Reader.bError)
+	{
+		return;
+	}
+
+	//Same order as the player input: actions first, then the axes
+	if (Actions & ClickAction)
+	{
+		Character->Click();
+	}
+	if (Actions & SwitchHandAction)
+	{
+		Character->SwitchSelectedHand();
+	}
+	if (Actions & SwitchRotationAxisAction)
+	{
+		Character->SwitchRotationAxis();
+	}
+	Character->MoveForward(Axes[MoveForwardAxis]);
+	Character->MoveRight(Axes[MoveRightAxis]);
+	Character->RotateObject(Axes[RotateObjectAxis]);
+	Character->MoveItemY(Axes[MoveItemYAxis]);
+	Character->MoveItemZ(Axes[MoveItemZAxis]);
+
+	//The recorded rotation is the one at the end of the frame, after the handlers used the previous one
+	if (Character->GetController())
+	{
+		const FRotator ControlRotation(Replayed.ControlRotation[0] / RotationScale, Replayed.ControlRotation[1] / RotationScale, Replayed.ControlRotation[2] / RotationScale);
+		Character->GetController()->SetControlRotation(ControlRotation);
+	}
+}
+
+AMyCharacter* AKitchenReplay::ResolveCharacter(uint32 Id)
+{
+	FReplayedCharacter* Replayed = Characters.Find(Id);
+	if (Replayed)
+	{
+		return Replayed->Character.Get();
+	}
+
+	const FString* Name = ActorNames.Find(Id);
+	AMyCharacter* Character = Name ? FindObject<AMyCharacter>(nullptr, **Name) : nullptr;
+
+	//The player character is spawned at runtime and may not get the same name
+	if (!Character && !bPlayerAssigned)
+	{
+		APlayerController* PlayerController = GetWorld()->GetFirstPlayerController();
+		Character = PlayerController ? Cast<AMyCharacter>(PlayerController->GetPawn()) : nullptr;
+	}
+	if (!Character)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Kitchen replay has no character for %s, its input is skipped"), Name ? **Name : TEXT("an unnamed actor"));
+	}
+	else
+	{
+		bPlayerAssigned |= Character->IsPlayerControlled();
+		Character->AddTickPrerequisiteActor(this);
+	}
+
+	Characters.Add(Id).Character = Character;
+	return Character;
+}
+
+void AKitchenReplay::Finish()
+{
+	bFinished = true;
+	const double WallSeconds = FPlatformTime::Seconds() - StartSeconds;
+
+	AInteractableRegistry* Registry = AInteractableRegistry::FindInWorld(GetWorld());
+
+	//Items where the recording left them
+	int32 NumItems = 0;
+	int32 NumItemMismatches = 0;
+	for (const auto& Entry : RecordedTransforms)
+	{
+		const FString* Name = ActorNames.Find(Entry.Key);
+		const AActor* Actor = Name ? FindObject<AActor>(nullptr, **Name) : nullptr;
+		NumItems++;
+
+		const UInteractableComponent* Item = Registry ? Registry->Find(Actor) : nullptr;
+		if (!Item || !Item->GetMesh())
+		{
+			UE_LOG(LogTemp, Error, TEXT("Kitchen replay mismatch: %s is not in the kitchen"), Name ? **Name : TEXT("an unnamed item"));
+			NumItemMismatches++;
+			continue;
+		}
+
+		const FVector Location = Item->GetMesh()->GetComponentLocation();
+		const FRotator Rotation = Item->GetMesh()->GetComponentRotation();
+		const float Distance = FVector::Dist(Location, Entry.Value.GetLocation());
+		const FRotator RotationDelta = (Rotation - Entry.Value.GetRotation()).GetNormalized();
+		const float Angle = FMath::Max3(FMath::Abs(RotationDelta.Pitch), FMath::Abs(RotationDelta.Yaw), FMath::Abs(RotationDelta.Roll));
+		if (Distance > LocationTolerance || Angle > RotationTolerance)
+		{
+			UE_LOG(LogTemp, Error, TEXT("Kitchen replay mismatch: %s is %.2f cm and %.2f degrees away from the recording"), **Name, Distance, Angle);
+			NumItemMismatches++;
+		}
+	}
+
+	//Drawers and doors in the recorded state
+	int32 NumOpenableMismatches = 0;
+	for (const auto& Entry : RecordedStates)
+	{
+		const FString* Name = ActorNames.Find(Entry.Key);
+		const AActor* Actor = Name ? FindObject<AActor>(nullptr, **Name) : nullptr;
+		const UInteractableComponent* Openable = Registry ? Registry->Find(Actor) : nullptr;
+		if (!Openable || static_cast<uint8>(Openable->AssetState) != Entry.Value)
+		{
+			UE_LOG(LogTemp, Error, TEXT("Kitchen replay mismatch: %s is not in its recorded state"), Name ? **Name : TEXT("an unnamed openable"));
+			NumOpenableMismatches++;
+		}
+	}
+
+	const bool bMatches = NumItemMismatches == 0 && NumOpenableMismatches == 0;
+	FString Csv = TEXT("Metric,Value\n");
+	Csv += FString::Printf(TEXT("Frames,%d\n"), NumFrames);
+	Csv += FString::Printf(TEXT("Recorded Duration (s),%.3f\n"), RecordedTime);
+	Csv += FString::Printf(TEXT("Replay Duration (s),%.3f\n"), WallSeconds);
+	Csv += FString::Printf(TEXT("Speedup,%.2f\n"), WallSeconds > 0.0 ? RecordedTime / WallSeconds : 0.0);
+	Csv += FString::Printf(TEXT("FrameTime P50 (ms),%.3f\n"), AKitchenBenchmark::Percentile(FrameTimes, 0.5f));
+	Csv += FString::Printf(TEXT("FrameTime P95 (ms),%.3f\n"), AKitchenBenchmark::Percentile(FrameTimes, 0.95f));
+	Csv += FString::Printf(TEXT("FrameTime Max (ms),%.3f\n"), AKitchenBenchmark::Percentile(FrameTimes, 1.f));
+	Csv += FString::Printf(TEXT("Recorded Events,%d\n"), NumEvents);
+	Csv += FString::Printf(TEXT("Items,%d\n"), NumItems);
+	Csv += FString::Printf(TEXT("Item Mismatches,%d\n"), NumItemMismatches);
+	Csv += FString::Printf(TEXT("Openables,%d\n"), RecordedStates.Num());
+	Csv += FString::Printf(TEXT("Openable Mismatches,%d\n"), NumOpenableMismatches);
+	Csv += FString::Printf(TEXT("Matches,%d\n"), bMatches ? 1 : 0);
+
+	FString CsvPath;
+	if (!FParse::Value(FCommandLine::Get(), TEXT("ReplayCsv="), CsvPath))
+	{
+		CsvPath = FPaths::GameSavedDir() / TEXT("Replay") / FString::Printf(TEXT("KitchenReplay-%s.csv"), *FDateTime::Now().ToString());
+	}
+
+	if (FFileHelper::SaveStringToFile(Csv, *CsvPath))
+	{
+		UE_LOG(LogTemp, Log, TEXT("Kitchen replay results written to %s"), *CsvPath);
+	}
+	else
+	{
+		UE_LOG(LogTemp, Error, TEXT("Kitchen replay could not write %s"), *CsvPath);
+	}
+
+	if (bMatches)
+	{
+		UE_LOG(LogTemp, Log, TEXT("Kitchen replay matches the recording"));
+	}
+	else
+	{
+		UE_LOG(LogTemp, Error, TEXT("Kitchen replay diverged from the recording: %d items and %d openables differ"), NumItemMismatches, NumOpenableMismatches);
+	}
+
+	FPlatformMisc::RequestExit(false);
+}
@@ -0,0 +1,106 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "GameFramework/Actor.h"
+#include "RecordingFormat.h"
+#include "KitchenReplay.generated.h"
+
+class AMyCharacter;
+
+/**
+ * Plays a session recorded by AInteractionRecorder again, as a benchmark workload and as a
+ * regression check. Spawned by the game mode when the game is started with -KitchenReplay=<file>;
+ * every frame it feeds the recorded input to the input handlers of the character and advances the
+ * engine by the recorded frame time, without waiting for the wall clock. At the end of the recording
+ * the transforms of the items and the states of the drawers and doors are compared with the recorded
+ * ones, and the results are written to a CSV file before quitting. Runs headless with -nullrhi -unattended.
+ */
+UCLASS(config = Game)
+class KITCHEN_API AKitchenReplay : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	AKitchenReplay();
+
+	// Called when the game starts or when spawned
+	virtual void BeginPlay() override;
+
+	// Called when the game ends or when destroyed
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	// Called every frame, before the characters
+	virtual void Tick(float DeltaSeconds) override;
+
+	//Returns true if the game was started in replay mode
+	static bool IsReplayRequested();
+
+	//Time step of every frame in seconds, 0 replays the recorded frame times
+	UPROPERTY(config)
+	float FixedDeltaTime;
+
+	//Distance between a replayed and a recorded item above which it counts as a mismatch, in cm
+	UPROPERTY(config)
+	float LocationTolerance;
+
+	//Rotation difference above which an item counts as a mismatch, in degrees
+	UPROPERTY(config)
+	float RotationTolerance;
+
+protected:
+	//Recorded state of a character
+	struct FReplayedCharacter
+	{
+		TWeakObjectPtr<AMyCharacter> Character;
+		int32 ControlRotation[3];
+
+		FReplayedCharacter()
+		{
+			FMemory::Memzero(ControlRotation);
+		}
+	};
+
+	//Reads the records of the next frame and applies its input; returns false at the end of the recording
+	bool ReplayFrame();
+
+	//Frame time of the first Frame record from an offset, 0 if there is none
+	float PeekFrameDeltaTime(int32 Offset) const;
+
+	//Reads an Input record and drives the character with it
+	void ApplyInput(KitchenRecording::FReader& Reader);
+
+	//Returns the character recorded under an id, the player character for the first unknown one
+	AMyCharacter* ResolveCharacter(uint32 Id);
+
+	//Compares the kitchen with the end of the recording, writes the results and quits the game
+	void Finish();
+
+	//Content of the recording and where we are in it
+	TArray<uint8> Recording;
+	int32 ReadOffset;
+
+	//Path names of the actors, by recorded id
+	TMap<uint32, FString> ActorNames;
+
+	//Characters driven, by recorded id
+	TMap<uint32, FReplayedCharacter> Characters;
+
+	//Final state of the kitchen as recorded, by recorded id
+	TMap<uint32, KitchenRecording::FQuantizedTransform> RecordedTransforms;
+	TMap<uint32, uint8> RecordedStates;
+
+	//True once the player character is driven by a recorded character
+	bool bPlayerAssigned;
+
+	int32 NumFrames;
+	int32 NumEvents;
+	float RecordedTime;
+	double StartSeconds;
+	double LastFrameSeconds;
+
+	//Wall clock time of every replayed frame, in milliseconds
+	TArray<float> FrameTimes;
+
+	bool bFinished;
+};
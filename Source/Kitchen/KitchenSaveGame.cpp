@@ -0,0 +1,271 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Kitchen.h"
+#include "KitchenSaveGame.h"
+#include "InteractableRegistry.h"
+#include "InteractableComponent.h"
+#include "HandSlotComponent.h"
+#include "SettleManager.h"
+#include "MyCharacter.h"
+
+UKitchenSaveGame::UKitchenSaveGame()
+	: Version(CurrentVersion)
+{
+}
+
+//Saved paths have no editor prefix, so a scenario saved in the editor loads in the game and the other way round
+static FString ToWorldPath(UWorld* World, const FString& SavedPath)
+{
+	const int32 PIEInstance = World->GetOutermost()->PIEInstanceID;
+	if (PIEInstance == INDEX_NONE)
+	{
+		return SavedPath;
+	}
+
+	//The prefix goes in front of the name of the map package: /Game/Maps/UEDPIE_0_Kitchen.Kitchen:PersistentLevel.Cup
+	int32 PackageEnd = SavedPath.Find(TEXT("."));
+	if (PackageEnd == INDEX_NONE)
+	{
+		PackageEnd = SavedPath.Len();
+	}
+	const int32 NameStart = SavedPath.Find(TEXT("/"), ESearchCase::CaseSensitive, ESearchDir::FromEnd, PackageEnd) + 1;
+	return SavedPath.Left(NameStart) + FString::Printf(TEXT("%s_%d_"), PLAYWORLD_PACKAGE_PREFIX, PIEInstance) + SavedPath.Mid(NameStart);
+}
+
+static void SaveHand(const UHandSlotComponent* Hand, FSavedHand& OutHand)
+{
+	const AActor* HeldActor = Hand->GetHeldActor();
+	OutHand.ItemPath = HeldActor ? UWorld::RemovePIEPrefix(HeldActor->GetPathName()) : FString();
+	OutHand.YOffset = Hand->YOffset;
+	OutHand.ZOffset = Hand->ZOffset;
+	OutHand.HeldRotation = Hand->HeldRotation;
+}
+
+static void RestoreHand(UHandSlotComponent* Hand, const FSavedHand& SavedHand)
+{
+	if (!Hand->IsEmpty())
+	{
+		Hand->YOffset = SavedHand.YOffset;
+		Hand->ZOffset = SavedHand.ZOffset;
+		Hand->HeldRotation = SavedHand.HeldRotation;
+		Hand->UpdateHeldTransform();
+	}
+}
+
+//Registered item saved in a hand, null if the hand was empty or the item is not loaded
+static UInteractableComponent* FindHeldItem(UWorld* World, AInteractableRegistry* Registry, const FSavedHand& SavedHand)
+{
+	if (SavedHand.ItemPath.IsEmpty())
+	{
+		return nullptr;
+	}
+	const AActor* Actor = FindObject<AActor>(nullptr, *ToWorldPath(World, SavedHand.ItemPath));
+	UInteractableComponent* Item = Actor ? Registry->Find(Actor) : nullptr;
+	return Item && Item->IsItem() ? Item : nullptr;
+}
+
+//Player characters in the order of their controllers, the same in every session
+static void GetPlayerCharacters(UWorld* World, TArray<AMyCharacter*>& OutCharacters)
+{
+	for (FConstPlayerControllerIterator It = World->GetPlayerControllerIterator(); It; ++It)
+	{
+		AMyCharacter* Character = *It ? Cast<AMyCharacter>((*It)->GetPawn()) : nullptr;
+		if (Character)
+		{
+			OutCharacters.Add(Character);
+		}
+	}
+}
+
+void UKitchenSaveGame::Capture(UWorld* World)
+{
+	Version = CurrentVersion;
+	MapName = UWorld::RemovePIEPrefix(World->GetMapName());
+	Interactables.Reset();
+	Characters.Reset();
+
+	AInteractableRegistry* Registry = AInteractableRegistry::FindInWorld(World);
+	if (Registry)
+	{
+		TArray<UInteractableComponent*> Registered;
+		Registry->GetInteractables(EInteractableKind::Openable, Registered);
+		Registry->GetInteractables(EInteractableKind::Item, Registered);
+
+		Interactables.Reserve(Registered.Num() + Registry->GetSnapshots().Num());
+		int32 NumAwake = 0;
+		for (const UInteractableComponent* Interactable : Registered)
+		{
+			const UStaticMeshComponent* Mesh = Interactable->GetMesh();
+			FSavedInteractable& Saved = Interactables[Interactables.AddDefaulted()];
+			Saved.ActorPath = UWorld::RemovePIEPrefix(Interactable->GetOwner()->GetPathName());
+			Saved.AssetState = Interactable->AssetState;
+			Saved.Transform = Mesh ? Mesh->GetComponentTransform() : Interactable->GetOwner()->GetActorTransform();
+
+			//Held items are not simulating, they are given back to the hands
+			Saved.bAwake = Mesh && !Interactable->bHeld && Mesh->IsSimulatingPhysics() && Mesh->RigidBodyIsAwake();
+			NumAwake += Saved.bAwake ? 1 : 0;
+		}
+
+		//Interactables of unloaded levels, as they were left
+		for (const auto& Entry : Registry->GetSnapshots())
+		{
+			FSavedInteractable& Saved = Interactables[Interactables.AddDefaulted()];
+			Saved.ActorPath = UWorld::RemovePIEPrefix(Entry.Key);
+			Saved.AssetState = Entry.Value.AssetState;
+			Saved.Transform = Entry.Value.Transform;
+			Saved.bAwake = Entry.Value.bAwake;
+			NumAwake += Saved.bAwake ? 1 : 0;
+		}
+
+		if (NumAwake > 0)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("%d interactables were still moving when the scenario was saved, they will settle after every load"), NumAwake);
+		}
+	}
+
+	TArray<AMyCharacter*> PlayerCharacters;
+	GetPlayerCharacters(World, PlayerCharacters);
+	for (const AMyCharacter* Character : PlayerCharacters)
+	{
+		FSavedCharacter& Saved = Characters[Characters.AddDefaulted()];
+		Saved.Transform = Character->GetActorTransform();
+		Saved.ControlRotation = Character->GetControlRotation();
+		Saved.bRightHandSelected = Character->bRightHandSelected;
+		SaveHand(Character->RightHand, Saved.RightHand);
+		SaveHand(Character->LeftHand, Saved.LeftHand);
+	}
+}
+
+int32 UKitchenSaveGame::Apply(UWorld* World) const
+{
+	SCOPE_CYCLE_COUNTER(STAT_KitchenScenarioLoad);
+
+	AInteractableRegistry* Registry = AInteractableRegistry::Get(World);
+	ASettleManager* SettleManager = ASettleManager::Get(World);
+
+	//Hands are emptied first, the items they let go are placed with the others
+	TArray<AMyCharacter*> PlayerCharacters;
+	GetPlayerCharacters(World, PlayerCharacters);
+	for (AMyCharacter* Character : PlayerCharacters)
+	{
+		Character->ReleaseHeldItems();
+	}
+
+	//What the unloaded levels kept from before the load does not belong to the scenario
+	Registry->ResetSnapshots();
+
+	int32 NumPlaced = 0;
+	FInteractableSnapshot Snapshot;
+	for (const FSavedInteractable& Saved : Interactables)
+	{
+		Snapshot.AssetState = Saved.AssetState;
+		Snapshot.Transform = Saved.Transform;
+		Snapshot.bAwake = Saved.bAwake;
+
+		const FString ActorPath = ToWorldPath(World, Saved.ActorPath);
+		const AActor* Actor = FindObject<AActor>(nullptr, *ActorPath);
+		UInteractableComponent* Interactable = Actor ? Registry->Find(Actor) : nullptr;
+		if (!Interactable)
+		{
+			//Restored by the registry when the level becomes visible
+			Registry->SetSnapshot(ActorPath, Snapshot);
+			continue;
+		}
+
+		Registry->ApplySnapshot(Interactable, Snapshot);
+		Registry->UpdateLocation(Interactable);
+		if (Interactable->IsItem())
+		{
+			//Already asleep, the settle manager has nothing to wait for
+			SettleManager->Track(Interactable);
+		}
+		NumPlaced++;
+	}
+
+	for (int32 Index = 0; Index < FMath::Min(PlayerCharacters.Num(), Characters.Num()); Index++)
+	{
+		AMyCharacter* Character = PlayerCharacters[Index];
+		const FSavedCharacter& Saved = Characters[Index];
+
+		Character->SetActorTransform(Saved.Transform, false, nullptr, ETeleportType::TeleportPhysics);
+		if (Character->Controller)
+		{
+			Character->Controller->SetControlRotation(Saved.ControlRotation);
+		}
+
+		Character->bRightHandSelected = Saved.bRightHandSelected;
+		Character->RestoreHeldItems(FindHeldItem(World, Registry, Saved.RightHand), FindHeldItem(World, Registry, Saved.LeftHand));
+		RestoreHand(Character->RightHand, Saved.RightHand);
+		RestoreHand(Character->LeftHand, Saved.LeftHand);
+	}
+	return NumPlaced;
+}
+
+bool UKitchenSaveGame::SaveScenario(UWorld* World, const FString& SlotName)
+{
+	UKitchenSaveGame* SaveGame = Cast<UKitchenSaveGame>(UGameplayStatics::CreateSaveGameObject(UKitchenSaveGame::StaticClass()));
+	SaveGame->Capture(World);
+	if (!UGameplayStatics::SaveGameToSlot(SaveGame, SlotName, 0))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Could not save the scenario %s"), *SlotName);
+		return false;
+	}
+
+	UE_LOG(LogTemp, Log, TEXT("Saved the scenario %s: %d interactables, %d characters"), *SlotName, SaveGame->Interactables.Num(), SaveGame->Characters.Num());
+	return true;
+}
+
+bool UKitchenSaveGame::LoadScenario(UWorld* World, const FString& SlotName)
+{
+	const double StartSeconds = FPlatformTime::Seconds();
+
+	const UKitchenSaveGame* SaveGame = Cast<UKitchenSaveGame>(UGameplayStatics::LoadGameFromSlot(SlotName, 0));
+	if (!SaveGame)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("No scenario saved as %s"), *SlotName);
+		return false;
+	}
+	if (SaveGame->Version != CurrentVersion)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("The scenario %s has version %d, version %d was expected"), *SlotName, SaveGame->Version, CurrentVersion);
+		return false;
+	}
+	if (SaveGame->MapName != UWorld::RemovePIEPrefix(World->GetMapName()))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("The scenario %s was saved in %s, its actors may not be found"), *SlotName, *SaveGame->MapName);
+	}
+
+	const double ReadSeconds = FPlatformTime::Seconds();
+	const int32 NumPlaced = SaveGame->Apply(World);
+	const double EndSeconds = FPlatformTime::Seconds();
+
+	UE_LOG(LogTemp, Log, TEXT("Loaded the scenario %s: %d interactables placed, %d kept for unloaded levels, read in %.2f ms, applied in %.2f ms"),
+		*SlotName, NumPlaced, SaveGame->Interactables.Num() - NumPlaced,
+		(ReadSeconds - StartSeconds) * 1000.0, (EndSeconds - ReadSeconds) * 1000.0);
+	return true;
+}
+
+bool UKitchenSaveGame::IsScenarioRequested(FString& OutSlotName)
+{
+	return FParse::Value(FCommandLine::Get(), TEXT("KitchenScenario="), OutSlotName) && !OutSlotName.IsEmpty();
+}
+
+static void SaveScenarioCommand(const TArray<FString>& Args, UWorld* World)
+{
+	UKitchenSaveGame::SaveScenario(World, Args.Num() > 0 ? Args[0] : TEXT("Scenario"));
+}
+
+static void LoadScenarioCommand(const TArray<FString>& Args, UWorld* World)
+{
+	UKitchenSaveGame::LoadScenario(World, Args.Num() > 0 ? Args[0] : TEXT("Scenario"));
+}
+
+static FAutoConsoleCommandWithWorldAndArgs SaveScenarioConsoleCommand(
+	TEXT("Kitchen.SaveScenario"),
+	TEXT("Saves the drawers, items and hands of the kitchen to a slot. Argument: slot name, Scenario by default"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&SaveScenarioCommand));
+
+static FAutoConsoleCommandWithWorldAndArgs LoadScenarioConsoleCommand(
+	TEXT("Kitchen.LoadScenario"),
+	TEXT("Puts the kitchen in the state saved in a slot, with every body asleep. Argument: slot name, Scenario by default"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&LoadScenarioCommand));
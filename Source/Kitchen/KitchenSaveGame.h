@@ -0,0 +1,140 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "GameFramework/SaveGame.h"
+#include "KitchenTypes.h"
+#include "KitchenSaveGame.generated.h"
+
+//Saved state of an item, drawer or door
+USTRUCT()
+struct FSavedInteractable
+{
+	GENERATED_BODY()
+
+	//Path of the actor, stable between sessions for actors placed in the levels
+	UPROPERTY()
+	FString ActorPath;
+
+	UPROPERTY()
+	EAssetState AssetState;
+
+	UPROPERTY()
+	FTransform Transform;
+
+	//Still moving when saved; everything else is loaded asleep
+	UPROPERTY()
+	bool bAwake;
+
+	FSavedInteractable()
+		: AssetState(EAssetState::Unkown)
+		, bAwake(false)
+	{
+	}
+};
+
+//Saved content of a hand
+USTRUCT()
+struct FSavedHand
+{
+	GENERATED_BODY()
+
+	//Path of the held actor, empty for an empty hand
+	UPROPERTY()
+	FString ItemPath;
+
+	//Placement of the item chosen by the player, the grip of the item gives the rest
+	UPROPERTY()
+	float YOffset;
+
+	UPROPERTY()
+	float ZOffset;
+
+	UPROPERTY()
+	FRotator HeldRotation;
+
+	FSavedHand()
+		: YOffset(0.f)
+		, ZOffset(0.f)
+		, HeldRotation(ForceInitToZero)
+	{
+	}
+};
+
+//Saved state of a player character
+USTRUCT()
+struct FSavedCharacter
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	FTransform Transform;
+
+	UPROPERTY()
+	FRotator ControlRotation;
+
+	UPROPERTY()
+	bool bRightHandSelected;
+
+	UPROPERTY()
+	FSavedHand RightHand;
+
+	UPROPERTY()
+	FSavedHand LeftHand;
+
+	FSavedCharacter()
+		: ControlRotation(ForceInitToZero)
+		, bRightHandSelected(true)
+	{
+	}
+};
+
+/**
+ * A prepared kitchen scenario: drawer and door states, item transforms and the content of the
+ * hands of the players. Saved once the kitchen has settled, it is loaded by teleporting every
+ * body straight to its saved pose and putting it to sleep, so no physics warm-up is needed and
+ * switching scenarios only costs the teleports. Interactables of unloaded levels are handed to
+ * the registry, which restores them when their level becomes visible.
+ * Saved and loaded with Kitchen.SaveScenario and Kitchen.LoadScenario, or loaded at start with
+ * -KitchenScenario=<slot>.
+ */
+UCLASS()
+class KITCHEN_API UKitchenSaveGame : public USaveGame
+{
+	GENERATED_BODY()
+
+public:
+	//Format of the saved data, scenarios of another version are refused
+	static const int32 CurrentVersion = 1;
+
+	UKitchenSaveGame();
+
+	//Writes the state of the kitchen of the world to a save slot
+	static bool SaveScenario(UWorld* World, const FString& SlotName);
+
+	//Replaces the state of the kitchen of the world with the one of a save slot
+	static bool LoadScenario(UWorld* World, const FString& SlotName);
+
+	//Returns true and the slot to load if the game was started with -KitchenScenario=<slot>
+	static bool IsScenarioRequested(FString& OutSlotName);
+
+	//Fills this save with the current state of the kitchen
+	void Capture(UWorld* World);
+
+	//Puts the kitchen in the saved state; returns the number of interactables placed
+	int32 Apply(UWorld* World) const;
+
+	UPROPERTY()
+	int32 Version;
+
+	//Map the scenario was saved in, only used to warn about mismatches
+	UPROPERTY()
+	FString MapName;
+
+	UPROPERTY()
+	TArray<FSavedInteractable> Interactables;
+
+	//Player characters, in the order of their controllers
+	UPROPERTY()
+	TArray<FSavedCharacter> Characters;
+};
@@ -0,0 +1,97 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include <stdint.h>
+#include <atomic>
+
+/**
+ * Layout of the shared memory region filled by AWorldSnapshotService and read by external tools
+ * through KitchenSnapshotReader.h. Only standard C++ is used here, so the tools do not need the engine.
+ *
+ * The region holds a header, a table of actor names indexed by id, and a ring of NumSlots snapshots.
+ * Each snapshot is a struct of arrays: the items first, then the drawers and doors. The writer fills
+ * the slot after the latest one and publishes it by updating LatestSlot. Each slot is protected by a
+ * seqlock: its sequence is odd while the slot is written, so a reader copies or visits the slot and
+ * only keeps the result if the sequence was even and unchanged around the read. Readers never block
+ * the game, and with several slots they rarely have to retry.
+ */
+namespace KitchenSnapshot
+{
+	static const uint32_t Magic = 0x504E534B; // "KSNP" read as little endian
+	static const uint32_t Version = 1;
+
+	//Name of the shared memory region
+	static const char* const RegionName = "KitchenSnapshot";
+
+	//Capacity of the region
+	static const uint32_t MaxItems = 256;
+	static const uint32_t MaxOpenables = 128;
+	static const uint32_t MaxIds = MaxItems + MaxOpenables;
+	static const uint32_t MaxNameLength = 128;
+	static const uint32_t NumSlots = 4;
+
+	//Values of HeldBy
+	enum EHeldBy : uint8_t
+	{
+		NotHeld = 0,
+		RightHand = 1,
+		LeftHand = 2
+	};
+
+	//Values of OpenableStates, same as EAssetState
+	enum EOpenableState : uint8_t
+	{
+		Closed = 0,
+		Open = 1,
+		Unknown = 2
+	};
+
+	struct FSnapshotSlot
+	{
+		//Seqlock: odd while the writer fills the slot, incremented again when it is done
+		std::atomic<uint32_t> Sequence;
+
+		uint32_t NumItems;
+		uint32_t NumOpenables;
+
+		//Game frame and game time at which the snapshot was taken
+		uint64_t Frame;
+		double Time;
+
+		//Items, location in cm and rotation as a quaternion, in world space
+		uint32_t ItemIds[MaxItems];
+		float PositionX[MaxItems];
+		float PositionY[MaxItems];
+		float PositionZ[MaxItems];
+		float RotationX[MaxItems];
+		float RotationY[MaxItems];
+		float RotationZ[MaxItems];
+		float RotationW[MaxItems];
+		uint8_t HeldBy[MaxItems];
+
+		//Drawers and doors
+		uint32_t OpenableIds[MaxOpenables];
+		uint8_t OpenableStates[MaxOpenables];
+	};
+
+	struct FSnapshotRegion
+	{
+		uint32_t Magic;
+		uint32_t Version;
+		uint32_t RegionSize;
+
+		//Snapshots per second requested by the game
+		float UpdateRate;
+
+		//Number of snapshots published so far; the latest one is in Slots[(NumPublished - 1) % NumSlots]
+		std::atomic<uint64_t> NumPublished;
+
+		//Path names of the actors, indexed by id; a name is written once, before the id is first published
+		char Names[MaxIds][MaxNameLength];
+
+		FSnapshotSlot Slots[NumSlots];
+	};
+
+	static_assert(ATOMIC_INT_LOCK_FREE == 2 && ATOMIC_LLONG_LOCK_FREE == 2, "The snapshot region needs lock-free atomics to be shared between processes");
+}
@@ -0,0 +1,180 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "KitchenSnapshotLayout.h"
+
+#include <string.h>
+
+#if defined(_WIN32)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+/**
+ * Header-only reader of the snapshots published by AWorldSnapshotService, for external tools.
+ * It is not used by the game and only needs standard C++ and the platform shared memory API.
+ *
+ *     KitchenSnapshot::FReader Reader;
+ *     KitchenSnapshot::FSnapshotSlot Snapshot;
+ *     if (Reader.Open() && Reader.ReadLatest(Snapshot))
+ *     {
+ *         for (uint32_t Index = 0; Index < Snapshot.NumItems; Index++)
+ *         {
+ *             printf("%s %f\n", Reader.GetName(Snapshot.ItemIds[Index]), Snapshot.PositionZ[Index]);
+ *         }
+ *     }
+ *
+ * Visit() reads the latest slot in place, without copying it; the visitor may run on a slot which
+ * is being overwritten, so it must only gather values and drop them when Visit() returns false.
+ */
+namespace KitchenSnapshot
+{
+	class FReader
+	{
+	public:
+		FReader()
+			: Region(nullptr)
+#if defined(_WIN32)
+			, Mapping(nullptr)
+#endif
+		{
+		}
+
+		~FReader()
+		{
+			Close();
+		}
+
+		//Maps the region published by the game; returns false while the game has not created it
+		bool Open(const char* Name = RegionName)
+		{
+			Close();
+			void* Address = nullptr;
+#if defined(_WIN32)
+			Mapping = OpenFileMappingA(FILE_MAP_READ, FALSE, Name);
+			if (!Mapping)
+			{
+				return false;
+			}
+			Address = MapViewOfFile(Mapping, FILE_MAP_READ, 0, 0, sizeof(FSnapshotRegion));
+#else
+			char PosixName[MaxNameLength];
+			PosixName[0] = '/';
+			strncpy(PosixName + 1, Name, MaxNameLength - 2);
+			PosixName[MaxNameLength - 1] = 0;
+
+			const int File = shm_open(PosixName, O_RDONLY, 0);
+			if (File < 0)
+			{
+				return false;
+			}
+			Address = mmap(nullptr, sizeof(FSnapshotRegion), PROT_READ, MAP_SHARED, File, 0);
+			close(File);
+			if (Address == MAP_FAILED)
+			{
+				Address = nullptr;
+			}
+#endif
+			Region = static_cast<const FSnapshotRegion*>(Address);
+			if (!Region || Region->Magic != Magic || Region->Version != Version || Region->RegionSize != sizeof(FSnapshotRegion))
+			{
+				Close();
+				return false;
+			}
+			std::atomic_thread_fence(std::memory_order_acquire);
+			return true;
+		}
+
+		void Close()
+		{
+#if defined(_WIN32)
+			if (Region)
+			{
+				UnmapViewOfFile(Region);
+			}
+			if (Mapping)
+			{
+				CloseHandle(Mapping);
+				Mapping = nullptr;
+			}
+#else
+			if (Region)
+			{
+				munmap(const_cast<FSnapshotRegion*>(Region), sizeof(FSnapshotRegion));
+			}
+#endif
+			Region = nullptr;
+		}
+
+		//True while the game publishes; false once it has ended its session
+		bool IsLive() const
+		{
+			return Region && Region->Magic == Magic;
+		}
+
+		//Number of snapshots published so far, to detect new ones
+		uint64_t GetNumPublished() const
+		{
+			return Region ? Region->NumPublished.load(std::memory_order_acquire) : 0;
+		}
+
+		//Path name of the actor with an id, as published with its first snapshot
+		const char* GetName(uint32_t Id) const
+		{
+			return Region && Id < MaxIds ? Region->Names[Id] : "";
+		}
+
+		//Calls Visitor(const FSnapshotSlot&) on the latest snapshot; returns false if the snapshot changed meanwhile
+		template<typename TVisitor>
+		bool Visit(TVisitor&& Visitor) const
+		{
+			const uint64_t NumPublished = GetNumPublished();
+			if (NumPublished == 0)
+			{
+				return false;
+			}
+			const FSnapshotSlot& Slot = Region->Slots[(NumPublished - 1) % NumSlots];
+
+			const uint32_t Sequence = Slot.Sequence.load(std::memory_order_acquire);
+			if (Sequence & 1)
+			{
+				return false;
+			}
+			Visitor(Slot);
+			std::atomic_thread_fence(std::memory_order_acquire);
+			return Slot.Sequence.load(std::memory_order_relaxed) == Sequence;
+		}
+
+		//Copies the latest snapshot, retrying a few times if the game overwrites it during the copy
+		bool ReadLatest(FSnapshotSlot& OutSnapshot, int MaxAttempts = 8) const
+		{
+			for (int Attempt = 0; Attempt < MaxAttempts; Attempt++)
+			{
+				const bool bConsistent = Visit([&OutSnapshot](const FSnapshotSlot& Slot)
+				{
+					//The sequence is not part of the copy, the rest of the slot is plain data
+					const size_t Offset = sizeof(std::atomic<uint32_t>);
+					memcpy(reinterpret_cast<char*>(&OutSnapshot) + Offset, reinterpret_cast<const char*>(&Slot) + Offset, sizeof(FSnapshotSlot) - Offset);
+				});
+				if (bConsistent)
+				{
+					return true;
+				}
+			}
+			return false;
+		}
+
+	private:
+		const FSnapshotRegion* Region;
+#if defined(_WIN32)
+		HANDLE Mapping;
+#endif
+	};
+}
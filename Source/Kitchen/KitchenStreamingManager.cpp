@@ -0,0 +1,132 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Kitchen.h"
+#include "KitchenStreamingManager.h"
+#include "InteractableRegistry.h"
+#include "KitchenWorldManager.h"
+#include "Engine/LevelBounds.h"
+#include "Engine/LevelStreamingAlwaysLoaded.h"
+
+AKitchenStreamingManager::AKitchenStreamingManager()
+{
+	//Players walk slowly through the kitchen, a few checks per second are enough
+	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.TickGroup = TG_PostPhysics;
+
+	LoadDistance = 600.f;
+	UnloadDistance = 900.f;
+	UpdateInterval = 0.25f;
+}
+
+AKitchenStreamingManager* AKitchenStreamingManager::Get(UWorld* World)
+{
+	return GetWorldManager<AKitchenStreamingManager>(World);
+}
+
+void AKitchenStreamingManager::BeginPlay()
+{
+	Super::BeginPlay();
+
+	PrimaryActorTick.TickInterval = UpdateInterval;
+
+	for (const FKitchenStreamingArea& Area : Areas)
+	{
+		ULevelStreaming* StreamingLevel = FindStreamingLevel(Area);
+		if (!StreamingLevel)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("Kitchen streaming: %s is not a streaming level of this map"), *Area.LevelName.ToString());
+		}
+		else if (StreamingLevel->IsA<ULevelStreamingAlwaysLoaded>())
+		{
+			UE_LOG(LogTemp, Warning, TEXT("Kitchen streaming: %s is always loaded, set its streaming method to Blueprint"), *Area.LevelName.ToString());
+		}
+	}
+}
+
+void AKitchenStreamingManager::Tick(float DeltaSeconds)
+{
+	Super::Tick(DeltaSeconds);
+
+	AInteractableRegistry* Registry = AInteractableRegistry::FindInWorld(GetWorld());
+
+	for (FKitchenStreamingArea& Area : Areas)
+	{
+		ULevelStreaming* StreamingLevel = FindStreamingLevel(Area);
+		if (!StreamingLevel || StreamingLevel->IsA<ULevelStreamingAlwaysLoaded>())
+		{
+			continue;
+		}
+
+		//Areas without bounds stay loaded until they are known
+		if (!Area.Bounds.IsValid)
+		{
+			StreamingLevel->bShouldBeLoaded = true;
+			StreamingLevel->bShouldBeVisible = true;
+			UpdateBounds(Area, StreamingLevel);
+			continue;
+		}
+
+		const float Distance = GetClosestPlayerDistance(Area);
+		if (Distance < LoadDistance && !StreamingLevel->bShouldBeLoaded)
+		{
+			StreamingLevel->bShouldBeLoaded = true;
+			StreamingLevel->bShouldBeVisible = true;
+		}
+		else if (Distance > UnloadDistance && StreamingLevel->bShouldBeLoaded)
+		{
+			//An item carried out of its area would be destroyed with it
+			ULevel* Level = StreamingLevel->GetLoadedLevel();
+			if (Registry && Level && Registry->HasHeldItems(Level))
+			{
+				continue;
+			}
+			StreamingLevel->bShouldBeLoaded = false;
+			StreamingLevel->bShouldBeVisible = false;
+		}
+	}
+}
+
+ULevelStreaming* AKitchenStreamingManager::FindStreamingLevel(const FKitchenStreamingArea& Area) const
+{
+	const FString LevelName = Area.LevelName.ToString();
+	for (ULevelStreaming* StreamingLevel : GetWorld()->StreamingLevels)
+	{
+		//Package names carry the PIE prefix in the editor, compare the end only
+		if (StreamingLevel && FPackageName::GetShortName(StreamingLevel->GetWorldAssetPackageName()).EndsWith(LevelName))
+		{
+			return StreamingLevel;
+		}
+	}
+	return nullptr;
+}
+
+void AKitchenStreamingManager::UpdateBounds(FKitchenStreamingArea& Area, ULevelStreaming* StreamingLevel)
+{
+	ULevel* Level = StreamingLevel->GetLoadedLevel();
+	if (!Level || !StreamingLevel->IsLevelVisible())
+	{
+		return;
+	}
+
+	Area.Bounds = ALevelBounds::CalculateLevelBounds(Level);
+	if (Area.Bounds.IsValid)
+	{
+		//Paste into the config so the area is not loaded at startup next time
+		UE_LOG(LogTemp, Log, TEXT("Kitchen streaming: bounds of %s are Min=(%s) Max=(%s)"), *Area.LevelName.ToString(), *Area.Bounds.Min.ToString(), *Area.Bounds.Max.ToString());
+	}
+}
+
+float AKitchenStreamingManager::GetClosestPlayerDistance(const FKitchenStreamingArea& Area) const
+{
+	float ClosestDistanceSquared = MAX_FLT;
+	for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+	{
+		const APlayerController* PlayerController = *It;
+		const APawn* Pawn = PlayerController ? PlayerController->GetPawn() : nullptr;
+		if (Pawn)
+		{
+			ClosestDistanceSquared = FMath::Min(ClosestDistanceSquared, Area.Bounds.ComputeSquaredDistanceToPoint(Pawn->GetActorLocation()));
+		}
+	}
+	return ClosestDistanceSquared < MAX_FLT ? FMath::Sqrt(ClosestDistanceSquared) : MAX_FLT;
+}
@@ -0,0 +1,76 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "GameFramework/Info.h"
+#include "KitchenStreamingManager.generated.h"
+
+//Area of the kitchen streamed in and out with the distance to the players
+USTRUCT()
+struct FKitchenStreamingArea
+{
+	GENERATED_USTRUCT_BODY()
+
+	//Short name of the streaming level, e.g. FridgeLevel
+	UPROPERTY(config)
+	FName LevelName;
+
+	//World bounds of the level; when empty they are measured the first time the level is loaded
+	UPROPERTY(config)
+	FBox Bounds;
+
+	FKitchenStreamingArea()
+		: Bounds(ForceInit)
+	{
+	}
+};
+
+/**
+ * Loads the kitchen areas close to the players and unloads the far ones. Levels are streamed
+ * asynchronously through their streaming level objects; the interactable registry registers the
+ * actors of a level when it becomes visible and keeps their state while it is unloaded.
+ * Only levels using the Blueprint streaming method can be controlled, always loaded ones are left alone.
+ */
+UCLASS(config = Game)
+class KITCHEN_API AKitchenStreamingManager : public AInfo
+{
+	GENERATED_BODY()
+
+public:
+	AKitchenStreamingManager();
+
+	//Returns the streaming manager of the world, spawning it the first time it is requested
+	static AKitchenStreamingManager* Get(UWorld* World);
+
+	// Called when the game starts or when spawned
+	virtual void BeginPlay() override;
+
+	// Called every UpdateInterval seconds
+	virtual void Tick(float DeltaSeconds) override;
+
+	//Areas handled by the manager
+	UPROPERTY(config)
+	TArray<FKitchenStreamingArea> Areas;
+
+	//An area is loaded when a player gets closer than this to its bounds
+	UPROPERTY(config)
+	float LoadDistance;
+
+	//An area is unloaded when all players are further than this from its bounds
+	UPROPERTY(config)
+	float UnloadDistance;
+
+	//Seconds between two distance checks
+	UPROPERTY(config)
+	float UpdateInterval;
+
+private:
+	//Returns the streaming level of an area, nullptr if the persistent level does not stream it
+	ULevelStreaming* FindStreamingLevel(const FKitchenStreamingArea& Area) const;
+
+	//Measures the bounds of an area from its loaded level
+	void UpdateBounds(FKitchenStreamingArea& Area, ULevelStreaming* StreamingLevel);
+
+	//Returns the distance from the closest player to the bounds of an area
+	float GetClosestPlayerDistance(const FKitchenStreamingArea& Area) const;
+};
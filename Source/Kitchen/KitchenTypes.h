@@ -0,0 +1,116 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "Engine/DataTable.h"
+#include "KitchenTypes.generated.h"
+
+//Enum used in the TMap which keeps the state of the drawer
+UENUM(BlueprintType)
+enum class EAssetState : uint8
+{
+	Closed UMETA(DisplayName = "Closed"),
+	Open UMETA(DisplayName = "Open"),
+	Unkown UMETA(DisplayName = "Unkown"),
+
+	//Number of states, not a state; values are only appended before it
+	MAX UMETA(Hidden)
+};
+
+//Enum used when mapping the items
+UENUM(BlueprintType)
+enum class EItemType : uint8
+{
+	GeneralItem UMETA(DisplayName = "GeneralItem"),
+	Cup UMETA(DisplayName = "Cup"),
+	Plate UMETA(DisplayName = "Plate"),
+	Mug	UMETA(DisplayName = "Mug"),
+	Pan UMETA(DisplayName = "Pan"),
+	Spatula UMETA(DisplayName = "Spatula"),
+	Spoon UMETA(DisplayName = "Spoon"),
+
+	//Number of item types, not a type; values are only appended before it
+	MAX UMETA(Hidden)
+};
+
+//Names of the enum values, known at compile time so logging them needs no lookup in the reflection data
+FORCEINLINE const TCHAR* GetEnumName(EAssetState Value)
+{
+	static const TCHAR* const Names[] = { TEXT("Closed"), TEXT("Open"), TEXT("Unkown") };
+	static_assert(ARRAY_COUNT(Names) == static_cast<int32>(EAssetState::MAX), "EAssetState changed, update its names");
+	return static_cast<uint32>(Value) < ARRAY_COUNT(Names) ? Names[static_cast<uint32>(Value)] : TEXT("Invalid");
+}
+
+FORCEINLINE const TCHAR* GetEnumName(EItemType Value)
+{
+	static const TCHAR* const Names[] = { TEXT("GeneralItem"), TEXT("Cup"), TEXT("Plate"), TEXT("Mug"), TEXT("Pan"), TEXT("Spatula"), TEXT("Spoon") };
+	static_assert(ARRAY_COUNT(Names) == static_cast<int32>(EItemType::MAX), "EItemType changed, update its names");
+	return static_cast<uint32>(Value) < ARRAY_COUNT(Names) ? Names[static_cast<uint32>(Value)] : TEXT("Invalid");
+}
+
+//Enum describing what the character is currently doing, used to update the HUD prompts
+UENUM(BlueprintType)
+enum class EInteractionState : uint8
+{
+	Idle UMETA(DisplayName = "Idle"),
+	Hovering UMETA(DisplayName = "Hovering"),
+	Holding UMETA(DisplayName = "Holding"),
+	Rotating UMETA(DisplayName = "Rotating")
+};
+
+//Outline drawn around a highlighted mesh, written to the custom stencil so all styles share one post-process pass
+UENUM(BlueprintType)
+enum class EHighlightStyle : uint8
+{
+	None = 0 UMETA(DisplayName = "None"),
+	Item = 1 UMETA(DisplayName = "Item"),
+	Openable = 2 UMETA(DisplayName = "Openable")
+};
+
+//Row of the item catalog: describes how an item mesh is handled by the character
+USTRUCT(BlueprintType)
+struct FKitchenItemRow : public FTableRowBase
+{
+	GENERATED_USTRUCT_BODY()
+
+	//Mesh identifying the item
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Item)
+	TAssetPtr<UStaticMesh> Mesh;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Item)
+	EItemType ItemType;
+
+	//Position of the item relative to the hand holding it: X forward, Y to the side, Z up
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Item)
+	FVector GripOffset;
+
+	//Rotation of the item in hand, relative to the view of the character
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Item)
+	FRotator GripRotation;
+
+	//If false the item keeps the rotation it had when it was picked
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Item)
+	bool bUseGripRotation;
+
+	//Mass of the item in kg, 0 keeps the mass computed from the collision
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Item)
+	float Mass;
+
+	FKitchenItemRow()
+		: ItemType(EItemType::GeneralItem)
+		, GripOffset(20.f, 20.f, 30.f)
+		, GripRotation(0.f, 0.f, 0.f)
+		, bUseGripRotation(false)
+		, Mass(0.f)
+	{
+	}
+};
+
+//Catalog entry resolved at startup, with the values computed from the loaded mesh
+struct FKitchenItemInfo
+{
+	FKitchenItemRow Row;
+
+	//Local bounds of the mesh, so dropping an item does not need to compute them
+	FBox LocalBounds;
+};
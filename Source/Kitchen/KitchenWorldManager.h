@@ -0,0 +1,34 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "EngineUtils.h"
+
+//Returns the manager actor of the given class living in the world, nullptr if there is none
+template<typename TManager>
+TManager* FindWorldManager(UWorld* World)
+{
+	if (!World)
+	{
+		return nullptr;
+	}
+
+	//The iterator only visits actors of the manager class, not the whole level
+	for (TActorIterator<TManager> It(World); It; ++It)
+	{
+		return *It;
+	}
+	return nullptr;
+}
+
+//Returns the manager actor of the given class, spawning it the first time it is requested
+template<typename TManager>
+TManager* GetWorldManager(UWorld* World)
+{
+	TManager* Manager = FindWorldManager<TManager>(World);
+	if (!Manager && World)
+	{
+		Manager = World->SpawnActor<TManager>();
+	}
+	return Manager;
+}
@@ -2,8 +2,67 @@
 
 #include "Kitchen.h"
 #include "MyCharacter.h"
+#include "InteractableRegistry.h"
+#include "InteractableComponent.h"
+#include "HandSlotComponent.h"
+#include "FocusTraceScheduler.h"
+#include "OpenableDriveComponent.h"
+#include "SettleManager.h"
+#include "HighlightManager.h"
+#include "InteractionRecorder.h"
+#include "KitchenEventLog.h"
+#include "KitchenWorldManager.h"
 #include "GameFramework/InputSettings.h"
+#include "UnrealNetwork.h"
+
+static TAutoConsoleVariable<int32> CVarFocusTraceMode(
+	TEXT("Kitchen.FocusTraceMode"),
+	1,
+	TEXT("0: the focus trace blocks the game thread every frame\n")
+	TEXT("1: the focus trace runs asynchronously and its result is used on the next frame\n")
+	TEXT("2: the focus traces of all characters run together on the worker threads, results are used on the next frame"),
+	ECVF_Default);
+
+//Help messages for each interaction state, built once and shared by all characters
+namespace KitchenPrompts
+{
+	static const FText& Idle()
+	{
+		static const FText Text = NSLOCTEXT("Kitchen", "PromptIdle", "Use WASD for movement. \nTAB button to switch between which hand to use.");
+		return Text;
+	}
+
+	static const FText& Hovering()
+	{
+		static const FText Text = NSLOCTEXT("Kitchen", "PromptHovering", "Press click to interact \n(Grab or Open/Close Action)");
+		return Text;
+	}
+
+	static const FText& Holding()
+	{
+		static const FText Text = NSLOCTEXT("Kitchen", "PromptHolding", "Press R for rotation mode using the mouse wheel\nClick to drop item");
+		return Text;
+	}
+
+	static const FText& HoldingAdjust()
+	{
+		static const FText Text = NSLOCTEXT("Kitchen", "PromptHoldingAdjust", "You can use the keyboard arrows\nto adjust the position of item in hand");
+		return Text;
+	}
 
+	//Indexed by the rotation axis index, 1 to 3
+	static const FText& Rotating(int32 AxisIndex)
+	{
+		static const FText Texts[] =
+		{
+			FText::GetEmpty(),
+			NSLOCTEXT("Kitchen", "PromptRotateZ", "Rotate about Z axis. R to switch\nClick to drop item"),
+			NSLOCTEXT("Kitchen", "PromptRotateY", "Rotate about Y axis. R to switch\nClick to drop item"),
+			NSLOCTEXT("Kitchen", "PromptRotateX", "Rotate about X axis. R to switch\nClick to drop item")
+		};
+		return Texts[FMath::Clamp(AxisIndex, 0, 3)];
+	}
+}
 
 // Constructor which initializez the character parameters
 AMyCharacter::AMyCharacter()
@@ -15,8 +74,10 @@ AMyCharacter::AMyCharacter()
 	AutoPossessPlayer = EAutoReceiveInput::Player0;
 
 	//Help text to display at the beginig of the game
-	DisplayMessage = TEXT("Use WASD for movement. \nTAB button to switch between which hand to use.");
-	DisplayMessage2 = TEXT("");
+	InteractionState = EInteractionState::Idle;
+	DisplayMessage = KitchenPrompts::Idle();
+	DisplayMessage2 = FText::GetEmpty();
+	PromptRotationAxis = 0;
 
 	// Set size for collision capsule
 	GetCapsuleComponent()->InitCapsuleSize(5.f, 80.0f);
@@ -31,25 +92,35 @@ AMyCharacter::AMyCharacter()
 	MyCharacterCamera->RelativeLocation = FVector(0.f, 0.f, 64.f); // Position the camera
 	MyCharacterCamera->bUsePawnControlRotation = true;
 
-	//Set the value of the applied force
-	AppliedForce = FVector(1000, 1000, 1000);
-
-	//Initialize TraceParams parameter
-	TraceParams = FCollisionQueryParams(FName(TEXT("Trace")), true, this);
-	TraceParams.bTraceComplex = true;
+	//Initialize TraceParams parameter; the world is traced against simple collision only
+	TraceParams = FCollisionQueryParams(FName(TEXT("Trace")), false, this);
 	TraceParams.bTraceAsyncScene = true;
 	TraceParams.bReturnPhysicalMaterial = false;
 
+	//Interactables hit by the simple trace are refined against their triangles
+	ComplexTraceParams = FCollisionQueryParams(FName(TEXT("TraceComplex")), true, this);
+	ComplexTraceParams.bReturnPhysicalMaterial = false;
+
 	//Set the maximum grasping length
 	MaxGraspLength = 150.f;
 
+	//The 0.35 cm per frame the arrows always moved the item by, at 60 frames per second
+	ItemAdjustSpeed = 21.f;
+	FocusTraceCycles = 0;
+
 	//Set the pointers to the items held in hands to null at the begining of the game
 	LeftHandSlot = nullptr;
 	RightHandSlot = nullptr;
+	HighlightedInteractable = nullptr;
+	HighlightManager = nullptr;
+	HighlightRequest = nullptr;
+	Recorder = nullptr;
 
-	//Set the rotations to null
-	LeftHandRotator = FRotator(0.f, 0.f, 0.f);
-	RightHandRotator = FRotator(0.f, 0.f, 0.f);
+	//Create the hands which carry the picked items
+	RightHand = CreateDefaultSubobject<UHandSlotComponent>(TEXT("RightHand"));
+	RightHand->Side = 1.f;
+	LeftHand = CreateDefaultSubobject<UHandSlotComponent>(TEXT("LeftHand"));
+	LeftHand->Side = -1.f;
 
 	//By default our character will perfom actions with the right hand first
 	bRightHandSelected = true;
@@ -60,11 +131,19 @@ AMyCharacter::AMyCharacter()
 	// 1 - Z axis ; 2 - X axis ; 3 - Y axis ; 0 - default rotation disabled
 	RotationAxisIndex = 0;
 
-	//Offsets for positioning the items held in hand
-	RightZPos = 30.f;
-	LeftZPos = 30.f;
-	RightYPos = 20;
-	LeftYPos = 20;
+	//Ten pose updates per second at most, only while the owner adjusts an item
+	PoseSendTime = 0.f;
+	PoseSendInterval = 0.1f;
+}
+
+void AMyCharacter::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	DOREPLIFETIME(AMyCharacter, RightHandSlot);
+	DOREPLIFETIME(AMyCharacter, LeftHandSlot);
+	DOREPLIFETIME_CONDITION(AMyCharacter, RightHeldPose, COND_SkipOwner);
+	DOREPLIFETIME_CONDITION(AMyCharacter, LeftHeldPose, COND_SkipOwner);
 }
 
 // Called when the game starts or when spawned
@@ -72,156 +151,255 @@ void AMyCharacter::BeginPlay()
 {
 	Super::BeginPlay();
 	
-	//Gets all actors in the world, used for identifying our drawers and setting their initial state to closed
-	UGameplayStatics::GetAllActorsOfClass(GetWorld(), AActor::StaticClass(), AllActors);
+	//Drawers, doors and items register themselves in the world registry, shared by all characters
+	Registry = AInteractableRegistry::Get(GetWorld());
+
+	//Only present when the game was started with -KitchenRecord
+	Recorder = FindWorldManager<AInteractionRecorder>(GetWorld());
+}
+
+void AMyCharacter::OpenCloseAction(UInteractableComponent* Openable)
+{
+	SCOPE_CYCLE_COUNTER(STAT_KitchenOpenClose);
+
+	//Clicking on a handle opens the drawer or door it is attached to
+	Openable = Openable->GetOpenTarget();
+	if (!Openable || !Openable->GetDrive())
+	{
+		return;
+	}
+
+	//The drive reverses a drawer even while it moves; the state follows when the drawer stops
+	UOpenableDriveComponent* Drive = Openable->GetDrive();
+	Drive->SetOpen(!Drive->IsTargetOpen());
+
+	FKitchenEventLog::Log(Drive->IsTargetOpen() ? EKitchenEvent::Open : EKitchenEvent::Close, this, Openable->GetOwner(), 0, static_cast<int32>(Openable->AssetState));
+	if (Recorder)
+	{
+		Recorder->RecordEvent(Drive->IsTargetOpen() ? KitchenRecording::ERecordedEvent::Open : KitchenRecording::ERecordedEvent::Close, this, Openable, 0);
+	}
+}
+
+// Called every frame
+void AMyCharacter::Tick( float DeltaTime )
+{
+	SCOPE_CYCLE_COUNTER(STAT_KitchenCharacterTick);
+
+	Super::Tick( DeltaTime );
+
+	//The owner adjusts the held items, the server forwards their poses to the other clients
+	if (Role == ROLE_Authority)
+	{
+		RightHeldPose = RightHand->GetQuantizedPose();
+		LeftHeldPose = LeftHand->GetQuantizedPose();
+	}
+	else if (IsLocallyControlled())
+	{
+		SendHeldPoses(DeltaTime);
+	}
 
-	//Loop that checks if current object matches our drawer
-	for (const auto ActorIt : AllActors)
+	//Find what our character is looking at
+	const uint32 TraceStartCycles = FPlatformTime::Cycles();
+	UpdateFocusTrace();
+	FocusTraceCycles = FPlatformTime::Cycles() - TraceStartCycles;
+
+	//The highlighted actor went away with its streamed level
+	if (HighlightedActor && (HighlightedActor->IsPendingKill() || !HighlightedInteractable || !HighlightedInteractable->GetMesh()))
 	{
-		//Command used for determining the exact name of an actor. Only useful when designing.
-		//UE_LOG(LogTemp, Warning, TEXT("Actor name: %s"), *ActorIt->GetName());
+		SetHighlightedInteractable(nullptr);
+	}
 
-		//Finds the actors for the Handles, used to set the initial state of our drawers to closed 
-		if (ActorIt->GetName().Contains("Handle"))
+#if STATS
+	//Counts the allocations of every thread during the update, so 0 proves the prompts allocated nothing
+	const uint32 AllocationsBefore = FMalloc::TotalMallocCalls + FMalloc::TotalReallocCalls;
+#endif
+
+	//Mouse hovered behaviour with an empty hand
+	if (!SelectedObject)
+	{
+		//Check if there is an object blocking the hit and if it is in our hand's range
+		UInteractableComponent* Focused = nullptr;
+		if (HitObject.bBlockingHit && HitObject.Distance < MaxGraspLength)
 		{
-			if (GetStaticMesh(ActorIt) != nullptr)
+			//Check if the object has interractive behaviour enabled
+			UInteractableComponent* Interactable = Registry->Find(HitObject.GetActor());
+			if (Interactable && Interactable->GetMesh() && (Interactable->IsItem() || Interactable->IsOpenable()))
 			{
-				if (!ActorIt->GetName().Contains("Door"))
+				//Confirmed once when the focus moves to it, an interactable stays focused while it is looked at
+				if (Interactable == HighlightedInteractable || IsFocusHitVisible(HitObject))
 				{
-					GetStaticMesh(ActorIt)->AddImpulse(-1 * AppliedForce * ActorIt->GetActorForwardVector());
+					Focused = Interactable;
 				}
-				AssetStateMap.Add(ActorIt->GetAttachParentActor(), EAssetState::Closed);
 			}
 		}
-		//Remember to tag items when adding them into the world
-		//Or CREATE a function which does that automatically
-		else if (ActorIt->ActorHasTag(FName(TEXT("Item"))))
-		{
-			ItemMap.Add(ActorIt, EItemType::GeneralItem);
-		}
+		SetHighlightedInteractable(Focused);
+
+		//Show the interaction help only while something is focused
+		SetInteractionState(HighlightedActor ? EInteractionState::Hovering : EInteractionState::Idle);
 	}
-}
 
-UStaticMeshComponent* AMyCharacter::GetStaticMesh(AActor* Actor)
-{
-	for (auto Component : Actor->GetComponents())
+	//Behaviour for selected object in hand
+	else 
 	{
-		if (Component->GetName().Contains("StaticMeshComponent"))
-		{
-			return Cast<UStaticMeshComponent>(Component);
-		}
+		//Turn of the highlight effect because we can't pick up with this hand.
+		SetHighlightedInteractable(nullptr);
+
+		//Enable the player to access rotation mode
+		bRotationModeAllowed = true;
+
+		//Tell the user that he can rotate the object, or around which axis it rotates
+		SetInteractionState(RotationAxisIndex ? EInteractionState::Rotating : EInteractionState::Holding);
 	}
-	return nullptr;
+
+#if STATS
+	INC_DWORD_STAT_BY(STAT_KitchenInteractionAllocations, FMalloc::TotalMallocCalls + FMalloc::TotalReallocCalls - AllocationsBefore);
+#endif
 }
 
-void AMyCharacter::OpenCloseAction(AActor* OpenableActor)
+void AMyCharacter::SetHighlightedInteractable(UInteractableComponent* Interactable)
 {
-	if (OpenableActor->GetName().Contains("Handle"))
+	if (Interactable == HighlightedInteractable && HighlightedActor)
 	{
-		OpenableActor = OpenableActor->GetAttachParentActor();
+		return;
 	}
 
-	if (!AssetStateMap.Contains(OpenableActor))
+	//The outline is applied by the manager at the end of the frame, only the net change is rendered
+	if (HighlightRequest && HighlightManager)
 	{
-		return;
+		HighlightManager->RemoveHighlight(HighlightRequest);
 	}
+	HighlightRequest = nullptr;
 
-	else
+	HighlightedInteractable = Interactable;
+	HighlightedActor = Interactable ? Interactable->GetOwner() : nullptr;
+
+	//Characters which are not seen through do not draw outlines
+	if (Interactable && IsLocallyControlled() && IsPlayerControlled())
 	{
-		if (AssetStateMap.FindRef(OpenableActor) == EAssetState::Closed)
-		{
-			GetStaticMesh(OpenableActor)->AddImpulse(AppliedForce * OpenableActor->GetActorForwardVector());
-			AssetStateMap.Add(OpenableActor, EAssetState::Open);
-		}
-		else if (AssetStateMap.FindRef(HighlightedActor) == EAssetState::Open)
+		if (!HighlightManager)
 		{
-			GetStaticMesh(OpenableActor)->AddImpulse(-AppliedForce * OpenableActor->GetActorForwardVector());
-			AssetStateMap.Add(OpenableActor, EAssetState::Closed);
+			HighlightManager = AHighlightManager::Get(GetWorld());
 		}
+		HighlightRequest = Interactable->GetMesh();
+		HighlightManager->AddHighlight(HighlightRequest, Interactable->IsItem() ? EHighlightStyle::Item : EHighlightStyle::Openable);
+	}
+}
+
+void AMyCharacter::SetInteractionState(EInteractionState NewState)
+{
+	//Nothing changed, keep the current texts and don't wake the HUD
+	const int32 NewRotationAxis = NewState == EInteractionState::Rotating ? RotationAxisIndex : 0;
+	if (NewState == InteractionState && NewRotationAxis == PromptRotationAxis)
+	{
 		return;
 	}
+	InteractionState = NewState;
+	PromptRotationAxis = NewRotationAxis;
+
+	//Copying a cached text only shares its string, nothing is allocated
+	switch (NewState)
+	{
+	case EInteractionState::Idle:
+		DisplayMessage = KitchenPrompts::Idle();
+		DisplayMessage2 = FText::GetEmpty();
+		break;
+	case EInteractionState::Hovering:
+		DisplayMessage = KitchenPrompts::Hovering();
+		DisplayMessage2 = FText::GetEmpty();
+		break;
+	case EInteractionState::Holding:
+		DisplayMessage = KitchenPrompts::Holding();
+		DisplayMessage2 = KitchenPrompts::HoldingAdjust();
+		break;
+	case EInteractionState::Rotating:
+		DisplayMessage = KitchenPrompts::Rotating(PromptRotationAxis);
+		DisplayMessage2 = KitchenPrompts::HoldingAdjust();
+		break;
+	}
+
+	OnInteractionStateChanged.Broadcast(InteractionState, PromptRotationAxis);
 }
 
-// Called every frame
-void AMyCharacter::Tick( float DeltaTime )
+void AMyCharacter::UpdateFocusTrace()
 {
-	Super::Tick( DeltaTime );
+	SCOPE_CYCLE_COUNTER(STAT_KitchenFocusTrace);
 
 	//Draw a straight line in front of our character
 	Start = MyCharacterCamera->GetComponentLocation();
 	End = Start + MyCharacterCamera->GetForwardVector()*MaxGraspLength;
-	HitObject = FHitResult(ForceInit);
-	GetWorld()->LineTraceSingleByChannel(HitObject, Start, End, ECC_Pawn, TraceParams);
 
-	//Mouse hovered behaviour with an empty hand
-	if (!SelectedObject)
+	const int32 TraceMode = CVarFocusTraceMode.GetValueOnGameThread();
+	if (TraceMode == 2)
 	{
-		//Turn off the highlight effect when changing to another actor
-		if (HighlightedActor && HitObject.GetActor() != HighlightedActor)
+		if (!TraceScheduler)
 		{
-			GetStaticMesh(HighlightedActor)->SetRenderCustomDepth(false);
-			HighlightedActor = nullptr;
-		}
-	
-		//Check if there is an object blocking the hit and if it is in our hand's range
-		if (HitObject.bBlockingHit && HitObject.Distance < MaxGraspLength)
-		{
-			//Check if the object has interractive behaviour enabled
-			if (AssetStateMap.Contains(HitObject.GetActor()) || AssetStateMap.Contains(HitObject.GetActor()->GetAttachParentActor()) || ItemMap.Contains(HitObject.GetActor()))
-			{
-				HighlightedActor = HitObject.GetActor();
-				GetStaticMesh(HighlightedActor)->SetRenderCustomDepth(true);
-			}
+			TraceScheduler = AFocusTraceScheduler::Get(GetWorld());
 		}
 
-		if (HighlightedActor)
+		//The batch already refined the hit, keep the previous one until a result is available
+		FHitResult BatchedHit(ForceInit);
+		if (TraceScheduler->GetResult(FocusTraceTicket, BatchedHit))
 		{
-			//Print a message to the screen
-			DisplayMessage = TEXT("Press click to interact \n(Grab or Open/Close Action)");
+			HitObject = BatchedHit;
 		}
-		else
-		{
-			//Reset text to empty
-			DisplayMessage = TEXT("Use WASD for movement. \nTAB button to switch between which hand to use.");
-		}
-
-		DisplayMessage2 = TEXT("");
+		FocusTraceTicket = TraceScheduler->RequestTrace(Start, End, GetFocusChannel(), TraceParams);
+		return;
 	}
 
-	//Behaviour for selected object in hand
-	else 
+	FHitResult SimpleHit(ForceInit);
+	if (TraceMode == 1)
 	{
-		//Turn of the highlight effect because we can't pick up with this hand.
-		if (HighlightedActor)
+		//Consume the trace started on the previous frame, it is never waited for
+		FTraceDatum TraceData;
+		if (GetWorld()->QueryTraceData(FocusTraceHandle, TraceData) && TraceData.OutHits.Num() > 0)
 		{
-			GetStaticMesh(HighlightedActor)->SetRenderCustomDepth(false);
-			HighlightedActor = nullptr;
+			SimpleHit = TraceData.OutHits[0];
 		}
 
-		//Enable the player to access rotation mode
-		bRotationModeAllowed = true;
+		//Start the trace used on the next frame
+		FocusTraceHandle = GetWorld()->AsyncLineTraceByChannel(EAsyncTraceType::Single, Start, End, GetFocusChannel(), TraceParams);
+	}
+	else
+	{
+		GetWorld()->LineTraceSingleByChannel(SimpleHit, Start, End, GetFocusChannel(), TraceParams);
+	}
 
-		if (!RotationAxisIndex)
-		{
-			//Display message to tell user that he can rotate an object
-			DisplayMessage = TEXT("Press R for rotation mode using the mouse wheel\nClick to drop item");
-			DisplayMessage2 = TEXT("You can use the keyboard arrows\nto adjust the position of item in hand");
-		}
+	HitObject = RefineFocusHit(SimpleHit);
+}
+
+FHitResult AMyCharacter::RefineFocusHit(const FHitResult& SimpleHit) const
+{
+	//Only interactables need the exact surface, everything else keeps the simple hit
+	UPrimitiveComponent* HitComponent = SimpleHit.GetComponent();
+	if (!SimpleHit.bBlockingHit || !HitComponent || !Registry || !Registry->Find(SimpleHit.GetActor()) || CVarRefineFocusTrace.GetValueOnGameThread() == 0)
+	{
+		return SimpleHit;
 	}
 
-	//Draw object from the right hand
-	if (RightHandSlot)
+	//Trace only the candidate component, with the current view, against its triangles
+	FHitResult ComplexHit(ForceInit);
+	if (HitComponent->LineTraceComponent(ComplexHit, Start, End, ComplexTraceParams))
 	{
-		RightHandSlot->SetActorRotation(RightHandRotator + FRotator(0.f, GetActorRotation().Yaw, 0.f));
-		GetStaticMesh(RightHandSlot)->SetWorldLocation(GetActorLocation() + FVector(20.f, 20.f, 20.f) * GetActorForwardVector() + FVector(RightYPos, RightYPos, RightYPos) * GetActorRightVector() + FVector(0.f, 0.f, RightZPos));
+		return ComplexHit;
 	}
 
-	//Draw object from the left hand
-	if (LeftHandSlot)
+	//The ray went through the simple collision but missed the actual mesh
+	return FHitResult(ForceInit);
+}
+
+bool AMyCharacter::IsFocusHitVisible(const FHitResult& FocusHit) const
+{
+	//The interactable channel is ignored by walls and furniture, the visibility channel is not
+	FHitResult Blocker(ForceInit);
+	if (!GetWorld()->LineTraceSingleByChannel(Blocker, Start, FocusHit.ImpactPoint, ECC_Visibility, TraceParams))
 	{
-		LeftHandSlot->SetActorRotation(LeftHandRotator + FRotator(0.f, GetActorRotation().Yaw, 0.f));
-		GetStaticMesh(LeftHandSlot)->SetWorldLocation(GetActorLocation() + FVector(20.f, 20.f, 20.f) * GetActorForwardVector() - FVector(LeftYPos, LeftYPos, LeftYPos) * GetActorRightVector() + FVector(0.f, 0.f, LeftZPos));
+		return true;
 	}
+
+	//Handles are hit with or through the drawer or door they are attached to
+	const AActor* FocusedActor = FocusHit.GetActor();
+	const AActor* BlockingActor = Blocker.GetActor();
+	return BlockingActor && FocusedActor && (BlockingActor == FocusedActor || FocusedActor->IsAttachedTo(BlockingActor));
 }
 
 /*
@@ -258,6 +436,11 @@ void AMyCharacter::SetupPlayerInputComponent(class UInputComponent* InputCompone
 
 void AMyCharacter::MoveForward(const float Value)
 {
+	if (Recorder)
+	{
+		Recorder->RecordAxis(this, KitchenRecording::MoveForwardAxis, Value);
+	}
+
 	if ((Controller != nullptr) && (Value != 0.0f))
 	{
 		// Find out which way is forward
@@ -275,6 +458,11 @@ void AMyCharacter::MoveForward(const float Value)
 
 void AMyCharacter::MoveRight(const float Value)
 {
+	if (Recorder)
+	{
+		Recorder->RecordAxis(this, KitchenRecording::MoveRightAxis, Value);
+	}
+
 	if ((Controller != nullptr) && (Value != 0.0f))
 	{
 		// find out which way is right
@@ -287,62 +475,91 @@ void AMyCharacter::MoveRight(const float Value)
 
 void AMyCharacter::SwitchSelectedHand()
 {
-	bRightHandSelected = !bRightHandSelected;
-	if (bRightHandSelected)
-	{
-		SelectedObject = RightHandSlot;
-		UE_LOG(LogTemp, Warning, TEXT("Our character will perform the next action with his RIGHT hand"));
-	}
-	else
+	if (Recorder)
 	{
-		SelectedObject = LeftHandSlot;
-		UE_LOG(LogTemp, Warning, TEXT("Our character will perform the next action with his LEFT hand"));
+		Recorder->RecordAction(this, KitchenRecording::SwitchHandAction);
 	}
 
+	bRightHandSelected = !bRightHandSelected;
+	SelectedObject = GetSelectedHand()->GetHeldActor();
+	FKitchenEventLog::Log(EKitchenEvent::SwitchHand, this, nullptr, bRightHandSelected ? 1 : -1);
+
 	//Exit rotation mode
 	RotationAxisIndex = 0;
+
+	if (Recorder)
+	{
+		Recorder->RecordEvent(KitchenRecording::ERecordedEvent::SwitchHand, this, nullptr, bRightHandSelected ? 1 : -1);
+	}
 }
 
 void AMyCharacter::Click()
 {
+	if (Recorder)
+	{
+		Recorder->RecordAction(this, KitchenRecording::ClickAction);
+	}
+
 	//Behaviour when we want to drop the item currently held in hand
 	if (SelectedObject && HitObject.Distance < MaxGraspLength)
 	{
 		//Drops our currently selected item on the surface clicked on
-		DropFromInventory(SelectedObject, HitObject);
+		if (Role == ROLE_Authority)
+		{
+			DropFromInventory(GetSelectedHand()->GetHeldItem(), HitObject);
+		}
+		else
+		{
+			ServerDrop(bRightHandSelected, HitObject.ImpactPoint, HitObject.ImpactNormal);
+		}
 	}
 
 	//Behaviour when wanting to grab an item or opening/closing actions
 	else if(HighlightedActor)
 	{
 		//Section for items that can be picked up and moved around
-		if (ItemMap.Contains(HighlightedActor))
+		if (HighlightedInteractable->IsItem())
 		{
-			//Picks up the item selected
-			SelectedObject = HighlightedActor;
-			PickToInventory(SelectedObject);
+			//Picks up the item selected; on a client the hand takes it when the server replicates the slot
+			if (Role == ROLE_Authority)
+			{
+				SelectedObject = HighlightedActor;
+				PickToInventory(HighlightedInteractable);
+			}
+			else
+			{
+				ServerPick(HighlightedActor, bRightHandSelected);
+			}
 		}
 
 		//Section for openable actors
+		else if (Role == ROLE_Authority)
+		{
+			OpenCloseAction(HighlightedInteractable);
+		}
 		else
 		{
-			OpenCloseAction(HighlightedActor);
+			ServerOpenClose(HighlightedActor);
 		}
 	}
 	else
 	{
-		UE_LOG(LogTemp, Warning, TEXT("Not a valid action!"));
+		FKitchenEventLog::Log(EKitchenEvent::InvalidClick, this, nullptr, bRightHandSelected ? 1 : -1);
 		return;
 	}
 }
 
-void AMyCharacter::PickToInventory(AActor* CurrentObject)
+void AMyCharacter::PickToInventory(UInteractableComponent* CurrentItem)
 {
-	//Add a reference and an icon of the object in the correct item slot (left or right hand) and save the value of our rotator
+	SCOPE_CYCLE_COUNTER(STAT_KitchenPick);
+
+	//The hand carries the item from now on, after physics each frame
+	GetSelectedHand()->Hold(CurrentItem);
+
+	//Add a reference and an icon of the object in the correct item slot (left or right hand)
 	if (bRightHandSelected)
 	{
-		RightHandSlot = CurrentObject;
-		RightHandRotator = RightHandSlot->GetActorRotation();
+		RightHandSlot = CurrentItem->GetOwner();
 
 		/*	DONE - via Blueprint
 		Add icon of the object in the inventory slot
@@ -350,8 +567,7 @@ void AMyCharacter::PickToInventory(AActor* CurrentObject)
 	}
 	else
 	{
-		LeftHandSlot = CurrentObject;
-		LeftHandRotator = LeftHandSlot->GetActorRotation();
+		LeftHandSlot = CurrentItem->GetOwner();
 
 		/*	DONE - via Blueprint
 		Add icon of the object in the inventory slot 
@@ -359,25 +575,58 @@ void AMyCharacter::PickToInventory(AActor* CurrentObject)
 	}
 
 	//Set collision to overlap other actors, we set up the GameTraceChannel1 to our custom overlapping collision.
-	//GetStaticMesh(CurrentObject)->SetCollisionObjectType(ECollisionChannel::ECC_GameTraceChannel1);
-	//Deactivate the gravity
-	GetStaticMesh(CurrentObject)->SetEnableGravity(false);
+	//CurrentItem->GetMesh()->SetCollisionObjectType(ECollisionChannel::ECC_GameTraceChannel1);
 	
 	//Ignore clicking on item if held in hand
-	TraceParams.AddIgnoredComponent(GetStaticMesh(CurrentObject));
+	TraceParams.AddIgnoredComponent(CurrentItem->GetMesh());
+
+	FKitchenEventLog::Log(EKitchenEvent::Pick, this, CurrentItem->GetOwner(), bRightHandSelected ? 1 : -1, static_cast<int32>(CurrentItem->ItemType));
+	if (Recorder)
+	{
+		Recorder->RecordEvent(KitchenRecording::ERecordedEvent::Pick, this, CurrentItem, bRightHandSelected ? 1 : -1);
+	}
 }
 
-void AMyCharacter::DropFromInventory(AActor* CurrentObject, FHitResult HitSurface)
+void AMyCharacter::DropFromInventory(UInteractableComponent* CurrentItem, FHitResult HitSurface)
 {
-	if (HitSurface.Distance > MaxGraspLength)
+	SCOPE_CYCLE_COUNTER(STAT_KitchenDrop);
+
+	if (HitSurface.Distance > MaxGraspLength || !CurrentItem)
+	{
+		return;
+	}
+	UStaticMeshComponent* CurrentMesh = CurrentItem->GetMesh();
+	UHandSlotComponent* OtherHand = bRightHandSelected ? LeftHand : RightHand;
+
+	//Find a pose where the item rests without intersecting anything, otherwise keep it in hand
+	FComponentQueryParams PlacementParams(TEXT("PlaceItem"), this);
+	PlacementParams.AddIgnoredComponent(CurrentMesh);
+	if (!OtherHand->IsEmpty())
 	{
+		PlacementParams.AddIgnoredComponent(OtherHand->GetHeldItem()->GetMesh());
+	}
+	FVector DropLocation;
+	if (!PlacementSolver.FindPlacement(CurrentMesh, HitSurface, PlacementParams, DropLocation))
+	{
+		FKitchenEventLog::Log(EKitchenEvent::DropRefused, this, CurrentItem->GetOwner(), bRightHandSelected ? 1 : -1, static_cast<int32>(CurrentItem->ItemType));
 		return;
 	}
-	//Find the bounding limits of the currently selected object 
-	GetStaticMesh(CurrentObject)->GetLocalBounds(Min, Max);
+
+	//Let go of the item, it simulates again from where we place it
+	GetSelectedHand()->Release();
 
 	//Method to move the object to our newly selected position
-	GetStaticMesh(CurrentObject)->SetWorldLocation(HitSurface.ImpactPoint + HitSurface.Normal*(( - Min) * GetStaticMesh(CurrentObject)->GetComponentScale()));
+	CurrentMesh->SetWorldLocation(DropLocation, false, nullptr, ETeleportType::TeleportPhysics);
+	CurrentItem->NotifyMoved();
+
+	//Let the item settle and put it to sleep as soon as it rests
+	ASettleManager::Get(GetWorld())->Track(CurrentItem);
+
+	FKitchenEventLog::Log(EKitchenEvent::Drop, this, CurrentItem->GetOwner(), bRightHandSelected ? 1 : -1, static_cast<int32>(CurrentItem->ItemType));
+	if (Recorder)
+	{
+		Recorder->RecordEvent(KitchenRecording::ERecordedEvent::Drop, this, CurrentItem, bRightHandSelected ? 1 : -1);
+	}
 
 	//Reset ignored parameters
 	TraceParams.ClearIgnoredComponents();
@@ -390,15 +639,6 @@ void AMyCharacter::DropFromInventory(AActor* CurrentObject, FHitResult HitSurfac
 		/*	DONE via blueprints
 		Remove icon of the object in the inventory slot
 		*/
-		//Reset the positioning vector back to default state
-		RightZPos = 30.f;
-		RightYPos = 20;
-
-		//Add item in left hand back to ignored actor by line trace
-		if (LeftHandSlot)
-		{
-			TraceParams.AddIgnoredComponent(GetStaticMesh(LeftHandSlot));
-		}
 	}
 	else
 	{
@@ -406,21 +646,16 @@ void AMyCharacter::DropFromInventory(AActor* CurrentObject, FHitResult HitSurfac
 		/*	DONE via blueprints
 		Remove icon of the object in the inventory slot
 		*/
-		//Reset the positioning vector back to default state
-		LeftZPos = 30.f;
-		LeftYPos = 20;
+	}
 
-		//Add item in right hand back to ignored actor by line trace
-		if (RightHandSlot)
-		{
-			TraceParams.AddIgnoredComponent(GetStaticMesh(RightHandSlot));
-		}
+	//Add the item in the other hand back to ignored actor by line trace
+	if (!OtherHand->IsEmpty())
+	{
+		TraceParams.AddIgnoredComponent(OtherHand->GetHeldItem()->GetMesh());
 	}
 
 	//Set collision back to physics body
-	//GetStaticMesh(CurrentObject)->SetCollisionObjectType(ECollisionChannel::ECC_PhysicsBody);
-	//Reactivate the gravity
-	GetStaticMesh(CurrentObject)->SetEnableGravity(true);
+	//CurrentMesh->SetCollisionObjectType(ECollisionChannel::ECC_PhysicsBody);
 
 	//Remove the reference because we just dropped the item that was selected
 	SelectedObject = nullptr;
@@ -433,6 +668,11 @@ void AMyCharacter::DropFromInventory(AActor* CurrentObject, FHitResult HitSurfac
 
 void AMyCharacter::SwitchRotationAxis()
 {
+	if (Recorder)
+	{
+		Recorder->RecordAction(this, KitchenRecording::SwitchRotationAxisAction);
+	}
+
 	//Exit function call if rotation is not permited here
 	if (!bRotationModeAllowed)
 	{
@@ -448,22 +688,22 @@ void AMyCharacter::SwitchRotationAxis()
 	}
 
 	//Update display text based on Rotation Axis Index
-	switch (RotationAxisIndex)
+	SetInteractionState(EInteractionState::Rotating);
+
+	FKitchenEventLog::Log(EKitchenEvent::RotationAxis, this, SelectedObject, bRightHandSelected ? 1 : -1, RotationAxisIndex);
+	if (Recorder)
 	{
-	case 1:
-		DisplayMessage = TEXT("Rotate about Z axis. R to switch\nClick to drop item");
-		break;
-	case 2:
-		DisplayMessage = TEXT("Rotate about Y axis. R to switch\nClick to drop item");
-		break;
-	case 3:
-		DisplayMessage = TEXT("Rotate about X axis. R to switch\nClick to drop item");
-		break;
+		Recorder->RecordEvent(KitchenRecording::ERecordedEvent::RotationAxis, this, nullptr, RotationAxisIndex);
 	}
 }
 
 void AMyCharacter::RotateObject(const float Value)
 {
+	if (Recorder)
+	{
+		Recorder->RecordAxis(this, KitchenRecording::RotateObjectAxis, Value);
+	}
+
 	//Check if controler is valid, input is not null and that we are in rotation mode
 	if ((Controller != nullptr) && (Value != 0.0f) && RotationAxisIndex)
 	{
@@ -487,55 +727,232 @@ void AMyCharacter::RotateObject(const float Value)
 		}
 
 		//Add our input to the currently selected object
-		if (bRightHandSelected)
-		{
-			RightHandRotator += RotIncrement;
-		}
-		else
-		{
-			LeftHandRotator += RotIncrement;
-		}
+		GetSelectedHand()->AddRotation(RotIncrement);
 	}
 }
 
 void AMyCharacter::MoveItemZ(const float Value)
 {
+	if (Recorder)
+	{
+		Recorder->RecordAxis(this, KitchenRecording::MoveItemZAxis, Value);
+	}
+
 	if ((Controller != nullptr) && (Value != 0.0f))
 	{
-		if (bRightHandSelected)
+		GetSelectedHand()->AdjustOffset(0.f, Value * ItemAdjustSpeed * GetWorld()->GetDeltaSeconds());
+	}
+}
+
+void AMyCharacter::MoveItemY(const float Value)
+{
+	if (Recorder)
+	{
+		Recorder->RecordAxis(this, KitchenRecording::MoveItemYAxis, Value);
+	}
+
+	if ((Controller != nullptr) && (Value != 0.0f))
+	{
+		GetSelectedHand()->AdjustOffset(Value * ItemAdjustSpeed * GetWorld()->GetDeltaSeconds(), 0.f);
+	}
+}
+
+void AMyCharacter::ReleaseHeldItems()
+{
+	RightHand->Release();
+	LeftHand->Release();
+	RightHandSlot = nullptr;
+	LeftHandSlot = nullptr;
+	SelectedObject = nullptr;
+	TraceParams.ClearIgnoredComponents();
+
+	bRotationModeAllowed = false;
+	RotationAxisIndex = 0;
+}
+
+void AMyCharacter::RestoreHeldItems(UInteractableComponent* RightItem, UInteractableComponent* LeftItem)
+{
+	ReleaseHeldItems();
+
+	if (RightItem)
+	{
+		RightHand->Hold(RightItem);
+		RightHandSlot = RightItem->GetOwner();
+		TraceParams.AddIgnoredComponent(RightItem->GetMesh());
+	}
+	if (LeftItem)
+	{
+		LeftHand->Hold(LeftItem);
+		LeftHandSlot = LeftItem->GetOwner();
+		TraceParams.AddIgnoredComponent(LeftItem->GetMesh());
+	}
+	SelectedObject = GetSelectedHand()->GetHeldActor();
+}
+
+//Slack given to the requests of clients, whose view is a few frames ahead of the server
+static const float NetReachTolerance = 30.f;
+
+bool AMyCharacter::IsWithinReach(const UInteractableComponent* Interactable) const
+{
+	const UStaticMeshComponent* Mesh = Interactable->GetMesh();
+	if (!Mesh)
+	{
+		return false;
+	}
+	const float Distance = FVector::Dist(MyCharacterCamera->GetComponentLocation(), Mesh->Bounds.Origin) - Mesh->Bounds.SphereRadius;
+	return Distance <= MaxGraspLength + NetReachTolerance;
+}
+
+bool AMyCharacter::ServerPick_Validate(AActor* Item, bool bRightHand)
+{
+	return true;
+}
+
+void AMyCharacter::ServerPick_Implementation(AActor* Item, bool bRightHand)
+{
+	UInteractableComponent* Interactable = Registry ? Registry->Find(Item) : nullptr;
+	bRightHandSelected = bRightHand;
+
+	//Another client may have picked it first; the hand of the client stays empty
+	if (!Interactable || !Interactable->IsItem() || Interactable->bHeld || !GetSelectedHand()->IsEmpty() || !IsWithinReach(Interactable))
+	{
+		return;
+	}
+	SelectedObject = Item;
+	PickToInventory(Interactable);
+}
+
+bool AMyCharacter::ServerDrop_Validate(bool bRightHand, FVector_NetQuantize10 SurfacePoint, FVector_NetQuantizeNormal SurfaceNormal)
+{
+	return true;
+}
+
+void AMyCharacter::ServerDrop_Implementation(bool bRightHand, FVector_NetQuantize10 SurfacePoint, FVector_NetQuantizeNormal SurfaceNormal)
+{
+	bRightHandSelected = bRightHand;
+	SelectedObject = GetSelectedHand()->GetHeldActor();
+
+	//The placement only needs the surface; the distance is measured again from the server view
+	FHitResult Surface(ForceInit);
+	Surface.bBlockingHit = true;
+	Surface.Location = Surface.ImpactPoint = SurfacePoint;
+	Surface.Normal = Surface.ImpactNormal = SurfaceNormal;
+	Surface.Distance = FMath::Max(FVector::Dist(MyCharacterCamera->GetComponentLocation(), SurfacePoint) - NetReachTolerance, 0.f);
+	DropFromInventory(GetSelectedHand()->GetHeldItem(), Surface);
+}
+
+bool AMyCharacter::ServerOpenClose_Validate(AActor* Target)
+{
+	return true;
+}
+
+void AMyCharacter::ServerOpenClose_Implementation(AActor* Target)
+{
+	UInteractableComponent* Interactable = Registry ? Registry->Find(Target) : nullptr;
+	if (Interactable && !Interactable->IsItem() && IsWithinReach(Interactable))
+	{
+		OpenCloseAction(Interactable);
+	}
+}
+
+bool AMyCharacter::ServerSetHeldPose_Validate(bool bRightHand, FQuantizedHeldPose Pose)
+{
+	//Further than two meters from the body is not a pose a hand can take
+	return FMath::Abs(Pose.YOffset) <= 2000 && FMath::Abs(Pose.ZOffset) <= 2000;
+}
+
+void AMyCharacter::ServerSetHeldPose_Implementation(bool bRightHand, FQuantizedHeldPose Pose)
+{
+	UHandSlotComponent* Hand = bRightHand ? RightHand : LeftHand;
+	if (!Hand->IsEmpty())
+	{
+		Hand->SetQuantizedPose(Pose);
+	}
+}
+
+void AMyCharacter::SendHeldPoses(float DeltaSeconds)
+{
+	PoseSendTime += DeltaSeconds;
+	if (PoseSendTime < PoseSendInterval)
+	{
+		return;
+	}
+
+	//Only what the arrows and the mouse wheel changed is sent
+	if (!RightHand->IsEmpty())
+	{
+		const FQuantizedHeldPose Pose = RightHand->GetQuantizedPose();
+		if (Pose != SentRightPose)
 		{
-			if ((Value < 0 && RightZPos > 20) || (Value >0 && RightZPos <40))
-			{
-				RightZPos += Value*0.35f;
-			}
+			ServerSetHeldPose(true, Pose);
+			SentRightPose = Pose;
+			PoseSendTime = 0.f;
 		}
-		else
+	}
+	if (!LeftHand->IsEmpty())
+	{
+		const FQuantizedHeldPose Pose = LeftHand->GetQuantizedPose();
+		if (Pose != SentLeftPose)
 		{
-			if ((Value < 0 && LeftZPos > 20) || (Value >0 && LeftZPos <40))
-			{
-				LeftZPos += Value*0.35f;
-			}
+			ServerSetHeldPose(false, Pose);
+			SentLeftPose = Pose;
+			PoseSendTime = 0.f;
 		}
 	}
 }
 
-void AMyCharacter::MoveItemY(const float Value)
+void AMyCharacter::OnRep_HandSlots()
 {
-	if ((Controller != nullptr) && (Value != 0.0f))
+	UHandSlotComponent* Hands[] = { RightHand, LeftHand };
+	AActor* Slots[] = { RightHandSlot, LeftHandSlot };
+	for (int32 Index = 0; Index < 2; Index++)
 	{
-		if (bRightHandSelected)
+		UHandSlotComponent* Hand = Hands[Index];
+		if (Hand->GetHeldActor() == Slots[Index])
 		{
-			if ((Value < 0 && RightYPos > 5) || (Value >0 && RightYPos <25))
-			{
-				RightYPos += Value*0.35f;
-			}
+			continue;
 		}
-		else
+
+		//The server moves the released item from now on
+		Hand->Release();
+		UInteractableComponent* Item = Slots[Index] && Registry ? Registry->Find(Slots[Index]) : nullptr;
+		if (Item)
 		{
-			if ((Value < 0 && LeftYPos <25) || (Value >0 && LeftYPos >5 ))
-			{
-				LeftYPos -= Value*0.35f;
-			}
+			Hand->Hold(Item);
+		}
+	}
+
+	//Same bookkeeping as a local pick or drop
+	TraceParams.ClearIgnoredComponents();
+	for (UHandSlotComponent* Hand : Hands)
+	{
+		if (!Hand->IsEmpty())
+		{
+			TraceParams.AddIgnoredComponent(Hand->GetHeldItem()->GetMesh());
 		}
 	}
-}
\ No newline at end of file
+	SelectedObject = GetSelectedHand()->GetHeldActor();
+	if (!SelectedObject)
+	{
+		bRotationModeAllowed = false;
+		RotationAxisIndex = 0;
+	}
+
+	//Holding starts from the grip of the item, the other clients then place it like its holder does
+	if (!IsLocallyControlled())
+	{
+		OnRep_HeldPoses();
+	}
+}
+
+void AMyCharacter::OnRep_HeldPoses()
+{
+	if (!RightHand->IsEmpty())
+	{
+		RightHand->SetQuantizedPose(RightHeldPose);
+	}
+	if (!LeftHand->IsEmpty())
+	{
+		LeftHand->SetQuantizedPose(LeftHeldPose);
+	}
+}
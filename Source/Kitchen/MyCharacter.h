@@ -3,31 +3,15 @@
 #pragma once
 
 
-//Enum used in the TMap which keeps the state of the drawer
-UENUM(BlueprintType)
-enum class EAssetState : uint8
-{
-	Closed UMETA(DisplayName = "Closed"),
-	Open UMETA(DisplayName = "Open"),
-	Unkown UMETA(DisplayName = "Unkown")
-};
-
-//Enum used when mapping the items
-UENUM(BlueprintType)
-enum class EItemType : uint8
-{
-	GeneralItem UMETA(DisplayName = "GeneralItem"),
-	Cup UMETA(DisplayName = "Cup"),
-	Plate UMETA(DisplayName = "Plate"),
-	Mug	UMETA(DisplayName = "Mug"),
-	Pan UMETA(DisplayName = "Pan"),
-	Spatula UMETA(DisplayName = "Spatula"),
-	Spoon UMETA(DisplayName = "Spoon")
-};
-
+#include "KitchenTypes.h"
+#include "FocusTraceScheduler.h"
+#include "ItemPlacementSolver.h"
+#include "HandSlotComponent.h"
 #include "GameFramework/Character.h"
 #include "MyCharacter.generated.h"
 
+//Raised only when the interaction state or the rotation axis changes, so the HUD can redraw its prompts
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FInteractionStateChangedSignature, EInteractionState, NewState, int32, RotationAxis);
 
 
 UCLASS()
@@ -35,6 +19,10 @@ class KITCHEN_API AMyCharacter : public ACharacter
 {
 	GENERATED_BODY()
 
+	//The benchmark and the replay drive the character through its input handlers
+	friend class AKitchenBenchmark;
+	friend class AKitchenReplay;
+
 public:
 	// Sets default values for this character's properties
 	AMyCharacter();
@@ -45,58 +33,112 @@ public:
 	// Called every frame
 	virtual void Tick( float DeltaSeconds ) override;
 
+	//Held items and their poses are replicated, the rest of the interaction state stays local
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
 	// Called to bind functionality to input
 	virtual void SetupPlayerInputComponent(class UInputComponent* InputComponent) override;
 
-	//Function to return a string out of the enum type
-	template<typename TEnum>
-	static FORCEINLINE FString GetEnumValueToString(const FString& Name, TEnum Value)
-	{
-		const UEnum* enumPtr = FindObject<UEnum>(ANY_PACKAGE, *Name, true);
-		if (!enumPtr)
-		{
-			return FString("Invalid");
-		}
-		return enumPtr->GetEnumName((int32)Value);
-	}
-
 	//Camera component for our character
 	class UCameraComponent* MyCharacterCamera;
 
-	//String used for displaying help messages for the user
+	//Text used for displaying help messages for the user, only changes with the interaction state
 	UPROPERTY(BlueprintReadOnly, VisibleAnywhere)
-	FString DisplayMessage;
+	FText DisplayMessage;
 
-	//String used for displaying help messages for the user
+	//Text used for displaying help messages for the user, only changes with the interaction state
 	UPROPERTY(BlueprintReadOnly, VisibleAnywhere)
-	FString DisplayMessage2;
+	FText DisplayMessage2;
 
-	//Array to store all actors in the world; used to find which object is selected
-	TArray<AActor*> AllActors;
+	//What the character is currently doing
+	UPROPERTY(BlueprintReadOnly, VisibleAnywhere)
+	EInteractionState InteractionState;
 
-	//TMap which keeps the open/closed state for our island drawers
-	TMap<AActor*, EAssetState> AssetStateMap;
+	//Event used by the HUD widget, a UInteractionPromptWidget, to update the help messages
+	UPROPERTY(BlueprintAssignable, Category = Interaction)
+	FInteractionStateChangedSignature OnInteractionStateChanged;
 
-	//TMap which keeps the interractive items from the kitchen
-	TMap<AActor*, EItemType> ItemMap;
+	//World registry which keeps the drawers, doors and items we can interact with
+	UPROPERTY()
+	class AInteractableRegistry* Registry;
 
 	//Actor pointer for the item currently selected
 	AActor* SelectedObject;
 
-	//Actor currently focused
+	//Actor currently focused; tracked by the garbage collector, so it is cleared when its streamed level goes away
+	UPROPERTY()
 	AActor* HighlightedActor;
 
+	//Interactable component of the focused actor, cached when the focus changes
+	UPROPERTY()
+	class UInteractableComponent* HighlightedInteractable;
+
+	//Outlines of the world, and the mesh this character asked to outline
+	UPROPERTY()
+	class AHighlightManager* HighlightManager;
+
+	UPROPERTY()
+	UPrimitiveComponent* HighlightRequest;
+
+	//Recorder of the session, null unless the game records
+	UPROPERTY()
+	class AInteractionRecorder* Recorder;
+
 	//Pointer to the item held in the right hand
-	UPROPERTY(BlueprintReadOnly, VisibleAnywhere)
+	UPROPERTY(ReplicatedUsing = OnRep_HandSlots, BlueprintReadOnly, VisibleAnywhere)
 	AActor* RightHandSlot;
 
 	//Pointer to the item held in the left hand
-	UPROPERTY(BlueprintReadOnly, VisibleAnywhere)
+	UPROPERTY(ReplicatedUsing = OnRep_HandSlots, BlueprintReadOnly, VisibleAnywhere)
 	AActor* LeftHandSlot;
 
-	//Parameters for the ray trace
+	//Placement of the held items for the other clients; the owner places its items itself
+	UPROPERTY(ReplicatedUsing = OnRep_HeldPoses)
+	FQuantizedHeldPose RightHeldPose;
+
+	UPROPERTY(ReplicatedUsing = OnRep_HeldPoses)
+	FQuantizedHeldPose LeftHeldPose;
+
+	//Last poses sent to the server by the owning client, and the time since the last send
+	FQuantizedHeldPose SentRightPose;
+	FQuantizedHeldPose SentLeftPose;
+	float PoseSendTime;
+
+	//Seconds between two pose updates sent by the owning client
+	float PoseSendInterval;
+
+	//Hands carrying the picked items
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Hand)
+	class UHandSlotComponent* RightHand;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Hand)
+	class UHandSlotComponent* LeftHand;
+
+	//Only interactables can be focused with an empty hand; with an item in hand the trace looks for a surface to drop it on
+	FORCEINLINE ECollisionChannel GetFocusChannel() const { return SelectedObject ? ECC_Pawn : ECC_Interactable; }
+
+	//Parameters for the ray trace, tested against simple collision
 	FCollisionQueryParams TraceParams;
 
+	//Parameters used to refine a hit on an interactable against its complex collision
+	FCollisionQueryParams ComplexTraceParams;
+
+	//Finds where a dropped item can rest
+	FItemPlacementSolver PlacementSolver;
+
+	//Handle of the asynchronous focus trace started on the previous frame
+	FTraceHandle FocusTraceHandle;
+
+	//Ticket of the focus trace queued in the shared scheduler on the previous frame
+	FFocusTraceTicket FocusTraceTicket;
+
+	//Scheduler running the focus traces of all characters together
+	UPROPERTY()
+	AFocusTraceScheduler* TraceScheduler;
+
+	//Time spent in the focus trace during the last frame, in cycles
+	uint32 FocusTraceCycles;
+
 	//Vectors used in ray tracing
 	FVector Start;
 	FVector End;
@@ -107,32 +149,21 @@ public:
 	//Variable for maximum grasping length
 	float MaxGraspLength;
 
+	//Speed at which the arrows move the item in hand, in cm/s
+	float ItemAdjustSpeed;
+
 	//Variable storing which hand should perform the next action
 	UPROPERTY(BlueprintReadOnly, VisibleAnywhere)
 	bool bRightHandSelected;
 
-	// Input variable for the force applied on the selected object
-	FVector AppliedForce;
-
-	//Vectors used for getting the size of an item
-	FVector Min;
-	FVector Max;
-
-	//Rotators used for positioning the items held in each hand
-	FRotator RightHandRotator;
-	FRotator LeftHandRotator;
-
-	//Variables to adjust the position of items held
-	float RightZPos;
-	float LeftZPos;
-	float RightYPos;
-	float LeftYPos;
-
 	//Boolean which tells when rotation mode is available
 	bool bRotationModeAllowed;
 	//Integer to store the index of rotation axis
 	int RotationAxisIndex;
 
+	//Rotation axis shown by the current help message
+	int32 PromptRotationAxis;
+
 protected:
 	/** Base turn rate, in deg/sec. Other scaling may affect final turn rate. */
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Camera)
@@ -154,17 +185,29 @@ protected:
 	//Switches between which hand will perform the next action
 	void SwitchSelectedHand();
 
-	//Function which returns the static mesh component of the selected object; NOT efficient --> Look for alternatives
-	UStaticMeshComponent* GetStaticMesh(AActor* Actor);
-
 	//Function to pick an item in one of our hands
-	void PickToInventory(AActor* CurrentObject);
+	void PickToInventory(class UInteractableComponent* CurrentItem);
 
 	//Function to release the currently held item
-	void DropFromInventory(AActor* CurrentObject, FHitResult HitSurface);
+	void DropFromInventory(class UInteractableComponent* CurrentItem, FHitResult HitSurface);
 
 	//Function to open / close drawers and doors
-	void OpenCloseAction(AActor* OpenableActor);
+	void OpenCloseAction(class UInteractableComponent* Openable);
+
+	//Changes the interaction state and the help messages, notifies the HUD only on a transition
+	void SetInteractionState(EInteractionState NewState);
+
+	//Changes the focused interactable and asks for its outline
+	void SetHighlightedInteractable(UInteractableComponent* Interactable);
+
+	//Updates HitObject with what the character is looking at
+	void UpdateFocusTrace();
+
+	//Retraces a hit on an interactable against its per-triangle collision
+	FHitResult RefineFocusHit(const FHitResult& SimpleHit) const;
+
+	//Traces the visibility channel up to a hit on an interactable; returns false if something else is in the way
+	bool IsFocusHitVisible(const FHitResult& FocusHit) const;
 
 	//Function to switch between the rotation axis each time player presses a key
 	void SwitchRotationAxis();
@@ -178,8 +221,44 @@ protected:
 	//Function to move the selected object up/down
 	void MoveItemZ(const float Value);
 
+	//Interactions asked by the owning client, performed and checked by the server
+	UFUNCTION(Server, Reliable, WithValidation)
+	void ServerPick(AActor* Item, bool bRightHand);
+
+	UFUNCTION(Server, Reliable, WithValidation)
+	void ServerDrop(bool bRightHand, FVector_NetQuantize10 SurfacePoint, FVector_NetQuantizeNormal SurfaceNormal);
+
+	UFUNCTION(Server, Reliable, WithValidation)
+	void ServerOpenClose(AActor* Target);
+
+	//Pose of a held item adjusted by the owning client; a lost update is replaced by the next one
+	UFUNCTION(Server, Unreliable, WithValidation)
+	void ServerSetHeldPose(bool bRightHand, FQuantizedHeldPose Pose);
+
+	//Sends the poses the owning client changed, at most every PoseSendInterval
+	void SendHeldPoses(float DeltaSeconds);
+
+	//Returns true if the interactable is close enough to the view of the character to be reached from the server
+	bool IsWithinReach(const class UInteractableComponent* Interactable) const;
+
+	//Holds or releases the items the server says the hands hold
+	UFUNCTION()
+	void OnRep_HandSlots();
+
+	UFUNCTION()
+	void OnRep_HeldPoses();
+
 public:
+	/** Returns the hand which performs the next action **/
+	FORCEINLINE class UHandSlotComponent* GetSelectedHand() const { return bRightHandSelected ? RightHand : LeftHand; }
+
 	/** Returns FirstPersonCameraComponent subobject **/
 	FORCEINLINE class UCameraComponent* GetMyCharacterCamera() const { return MyCharacterCamera; }
+
+	//Empties both hands where they are, without placing the items; used before a saved kitchen replaces the current one
+	void ReleaseHeldItems();
+
+	//Puts items straight in the hands, as they were saved; null leaves a hand empty
+	void RestoreHeldItems(class UInteractableComponent* RightItem, class UInteractableComponent* LeftItem);
 	
 };
@@ -0,0 +1,241 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Kitchen.h"
+#include "OpenableDriveComponent.h"
+#include "InteractableComponent.h"
+#include "KitchenEventLog.h"
+#include "KitchenWorldManager.h"
+#include "SettleManager.h"
+#include "PhysicsEngine/PhysicsConstraintComponent.h"
+
+UOpenableDriveComponent::UOpenableDriveComponent()
+{
+	//Everything happens in the physics callbacks
+	PrimaryComponentTick.bCanEverTick = false;
+
+	OpenDistance = 30.f;
+	OpenAngle = 90.f;
+	DriveStiffness = 500.f;
+	DriveDamping = 50.f;
+	DriveForceLimit = 0.f;
+	StateTolerance = 0.1f;
+	FallbackImpulse = 1000.f;
+
+	Openable = nullptr;
+	Constraint = nullptr;
+	bLinear = true;
+	DriveAxis = FVector::ForwardVector;
+	OpenDirection = FVector::ForwardVector;
+	bTargetOpen = false;
+	bDriveEnabled = false;
+}
+
+void UOpenableDriveComponent::Initialize(UInteractableComponent* InOpenable, UPhysicsConstraintComponent* InConstraint)
+{
+	Openable = InOpenable;
+	Constraint = InConstraint;
+	UStaticMeshComponent* Mesh = Openable ? Openable->GetMesh() : nullptr;
+	if (!Mesh)
+	{
+		return;
+	}
+
+	ClosedTransform = Mesh->GetComponentTransform();
+	OpenDirection = GetOwner()->GetActorForwardVector();
+
+	//The free axis of the constraint tells drawers from doors
+	if (Constraint)
+	{
+		const FConstraintInstance& Instance = Constraint->ConstraintInstance;
+		if (Instance.LinearXMotion != LCM_Locked)
+		{
+			DriveAxis = FVector(1.f, 0.f, 0.f);
+		}
+		else if (Instance.LinearYMotion != LCM_Locked)
+		{
+			DriveAxis = FVector(0.f, 1.f, 0.f);
+		}
+		else if (Instance.LinearZMotion != LCM_Locked)
+		{
+			DriveAxis = FVector(0.f, 0.f, 1.f);
+		}
+		else
+		{
+			bLinear = false;
+			if (Instance.AngularSwing1Motion != ACM_Locked)
+			{
+				DriveAxis = FVector(0.f, 0.f, 1.f);
+			}
+			else if (Instance.AngularSwing2Motion != ACM_Locked)
+			{
+				DriveAxis = FVector(0.f, 1.f, 0.f);
+			}
+			else if (Instance.AngularTwistMotion != ACM_Locked)
+			{
+				DriveAxis = FVector(1.f, 0.f, 0.f);
+			}
+			else
+			{
+				//Nothing moves, the constraint is not the one of the drawer
+				Constraint = nullptr;
+			}
+		}
+	}
+	if (!Constraint)
+	{
+		//Same rule as the handles, doors are named as such
+		bLinear = !GetOwner()->GetName().Contains("Door");
+	}
+
+	//The state is read when the body stops, no polling
+	Openable->EnableWakeEvents(Constraint);
+	Mesh->OnComponentWake.AddDynamic(this, &UOpenableDriveComponent::OnBodyWake);
+	Mesh->OnComponentSleep.AddDynamic(this, &UOpenableDriveComponent::OnBodySleep);
+}
+
+bool UOpenableDriveComponent::IsTargetOpen() const
+{
+	//Before the first action the drawer is where it was placed or restored
+	if (!bDriveEnabled)
+	{
+		return Openable && Openable->AssetState == EAssetState::Open;
+	}
+	return bTargetOpen;
+}
+
+void UOpenableDriveComponent::SetOpen(bool bOpen)
+{
+	UStaticMeshComponent* Mesh = Openable ? Openable->GetMesh() : nullptr;
+	if (!Mesh)
+	{
+		return;
+	}
+	bTargetOpen = bOpen;
+
+	if (!Constraint)
+	{
+		//Nothing to drive, push the body like the character always did
+		Mesh->AddImpulse((bOpen ? 1.f : -1.f) * FVector(FallbackImpulse) * OpenDirection);
+	}
+	else
+	{
+		SetDriveTarget(bOpen);
+	}
+
+	//Moving until the body settles, with the items resting in it
+	Mesh->WakeRigidBody();
+	if (ASettleManager* SettleManager = FindWorldManager<ASettleManager>(GetWorld()))
+	{
+		SettleManager->UnlockTouching(Mesh);
+	}
+	Openable->AssetState = EAssetState::Unkown;
+	Openable->SetNetDormant(false);
+}
+
+void UOpenableDriveComponent::RestorePose(const FTransform& Transform, EAssetState State)
+{
+	UStaticMeshComponent* Mesh = Openable ? Openable->GetMesh() : nullptr;
+	if (!Mesh)
+	{
+		return;
+	}
+
+	//The motor has to hold the restored pose, or it pulls the body back on the next wake
+	if (bDriveEnabled && Constraint && State != EAssetState::Unkown)
+	{
+		bTargetOpen = State == EAssetState::Open;
+		SetDriveTarget(bTargetOpen);
+	}
+
+	Mesh->SetWorldTransform(Transform, false, nullptr, ETeleportType::TeleportPhysics);
+	if (Mesh->IsSimulatingPhysics())
+	{
+		Mesh->PutRigidBodyToSleep();
+	}
+	Openable->AssetState = State;
+}
+
+void UOpenableDriveComponent::SetDriveTarget(bool bOpen)
+{
+	if (bLinear)
+	{
+		if (!bDriveEnabled)
+		{
+			Constraint->SetLinearDriveParams(DriveStiffness, DriveDamping, DriveForceLimit);
+			Constraint->SetLinearPositionDrive(DriveAxis.X != 0.f, DriveAxis.Y != 0.f, DriveAxis.Z != 0.f);
+		}
+
+		//The target is expressed in the constraint frame, pointing out of the furniture
+		const FVector WorldAxis = Constraint->GetComponentTransform().TransformVectorNoScale(DriveAxis);
+		const float Sign = FVector::DotProduct(WorldAxis, OpenDirection) < 0.f ? -1.f : 1.f;
+		Constraint->SetLinearPositionTarget(bOpen ? DriveAxis * Sign * OpenDistance : FVector::ZeroVector);
+	}
+	else
+	{
+		if (!bDriveEnabled)
+		{
+			Constraint->SetAngularDriveParams(DriveStiffness, DriveDamping, DriveForceLimit);
+			Constraint->SetAngularOrientationDrive(DriveAxis.X == 0.f, DriveAxis.X != 0.f);
+		}
+		Constraint->SetAngularOrientationTarget(bOpen ? FQuat(DriveAxis, FMath::DegreesToRadians(OpenAngle)) : FQuat::Identity);
+	}
+	bDriveEnabled = true;
+}
+
+float UOpenableDriveComponent::GetOpenFraction() const
+{
+	const UStaticMeshComponent* Mesh = Openable->GetMesh();
+	if (bLinear)
+	{
+		const float Travel = FVector::DotProduct(Mesh->GetComponentLocation() - ClosedTransform.GetLocation(), OpenDirection);
+		return Travel / FMath::Max(OpenDistance, KINDA_SMALL_NUMBER);
+	}
+
+	const FQuat Delta = Mesh->GetComponentQuat() * ClosedTransform.GetRotation().Inverse();
+	return FMath::RadiansToDegrees(Delta.GetAngle()) / FMath::Max(FMath::Abs(OpenAngle), KINDA_SMALL_NUMBER);
+}
+
+void UOpenableDriveComponent::OnBodyWake(UPrimitiveComponent* WakingComponent, FName BoneName)
+{
+	//Clients get the state from the server
+	if (Openable && GetOwnerRole() == ROLE_Authority)
+	{
+		Openable->AssetState = EAssetState::Unkown;
+		Openable->SetNetDormant(false);
+	}
+}
+
+void UOpenableDriveComponent::OnBodySleep(UPrimitiveComponent* SleepingComponent, FName BoneName)
+{
+	if (!Openable || !Openable->GetMesh())
+	{
+		return;
+	}
+
+	//The drawer only moves in the spatial queries once it rests; clients get its state from the server
+	Openable->NotifyMoved();
+	if (GetOwnerRole() != ROLE_Authority)
+	{
+		return;
+	}
+
+	//Without a constraint the travel is not known, anything away from the closed pose is open
+	const float OpenFraction = GetOpenFraction();
+	if (OpenFraction <= StateTolerance)
+	{
+		Openable->AssetState = EAssetState::Closed;
+	}
+	else if (!Constraint || OpenFraction >= 1.f - StateTolerance)
+	{
+		Openable->AssetState = EAssetState::Open;
+	}
+	else
+	{
+		Openable->AssetState = EAssetState::Unkown;
+	}
+
+	//The measured state goes out with the last update before the drawer stops replicating
+	Openable->SetNetDormant(true);
+
+	FKitchenEventLog::Log(EKitchenEvent::DrawerStopped, GetOwner(), nullptr, 0, static_cast<int32>(Openable->AssetState), OpenFraction);
+}
@@ -0,0 +1,98 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "Components/ActorComponent.h"
+#include "KitchenTypes.h"
+#include "OpenableDriveComponent.generated.h"
+
+class UInteractableComponent;
+class UPhysicsConstraintComponent;
+
+/**
+ * Opens and closes a drawer or a door by driving the motor of the physics constraint holding it,
+ * instead of pushing the body. The open/closed state is not assumed from the last action: it is
+ * measured by the server from the position of the body when it falls asleep, and is unknown while
+ * it moves or when it stopped half way; the clients receive it with the component. Nothing is woken up until the first action on the drawer.
+ */
+UCLASS(ClassGroup = (Kitchen), meta = (BlueprintSpawnableComponent))
+class KITCHEN_API UOpenableDriveComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	UOpenableDriveComponent();
+
+	//Binds the drive to the openable and the constraint holding it; the current pose is taken as the closed one
+	void Initialize(UInteractableComponent* InOpenable, UPhysicsConstraintComponent* InConstraint);
+
+	//Drives the body to the open or the closed position
+	void SetOpen(bool bOpen);
+
+	//Position the drive is moving the body to
+	bool IsTargetOpen() const;
+
+	//Places the body at a saved pose, asleep, and makes the motor hold it there
+	void RestorePose(const FTransform& Transform, EAssetState State);
+
+	//Distance a drawer travels when opened, in cm
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Drive)
+	float OpenDistance;
+
+	//Angle a door turns when opened, in degrees; negative for doors opening the other way
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Drive)
+	float OpenAngle;
+
+	//Spring, damper and force limit of the motor
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Drive)
+	float DriveStiffness;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Drive)
+	float DriveDamping;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Drive)
+	float DriveForceLimit;
+
+	//Fraction of the travel under which the body counts as closed, and above which it counts as open
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Drive)
+	float StateTolerance;
+
+	//Impulse used when no constraint holds the body, same as the character always applied
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Drive)
+	float FallbackImpulse;
+
+private:
+	//Physics callbacks of the driven body
+	UFUNCTION()
+	void OnBodyWake(UPrimitiveComponent* WakingComponent, FName BoneName);
+
+	UFUNCTION()
+	void OnBodySleep(UPrimitiveComponent* SleepingComponent, FName BoneName);
+
+	//Returns how far the body is from the closed pose, 0 closed and 1 fully open
+	float GetOpenFraction() const;
+
+	//Enables the motor of the constraint and sets its target to the open or the closed position
+	void SetDriveTarget(bool bOpen);
+
+	UPROPERTY()
+	UInteractableComponent* Openable;
+
+	UPROPERTY()
+	UPhysicsConstraintComponent* Constraint;
+
+	//True for drawers sliding along an axis, false for doors turning around their hinge
+	bool bLinear;
+
+	//Axis of the constraint frame the body moves along or turns around
+	FVector DriveAxis;
+
+	//World pose of the body when closed
+	FTransform ClosedTransform;
+
+	//Direction a drawer moves to open, in world space
+	FVector OpenDirection;
+
+	bool bTargetOpen;
+	bool bDriveEnabled;
+};
@@ -0,0 +1,273 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+/**
+ * Binary format of the kitchen recordings (.krec), shared by the recorder and the readers.
+ *
+ * The file starts with the magic "KREC" and a uint16 version, followed by records. Every record
+ * starts with a one byte ERecordType. Integers are written as variable length integers (7 bits
+ * per byte, least significant first), signed ones zigzag encoded first. Actors are referenced by
+ * an id, defined once by a Name record before its first use.
+ *
+ *   Name:      id, path name (length + UTF-8 bytes)
+ *   Frame:     ends a frame, the records before it happened during that frame;
+ *              frames since the previous Frame record, frame time in microseconds
+ *   Event:     ERecordedEvent, character id, target id (0 for none), signed value
+ *   Transform: item id, mask of the changed components, then for each changed component the signed
+ *              difference with the last recorded value; location in 1/100 cm, rotation in 1/100 degree
+ *   Input:     character id, EInputAction bits pressed during the frame, mask of the non-zero axes and of
+ *              the changed control rotation components, then the axis values in 1/1000 and the changed
+ *              control rotation components in 1/100 degree
+ *   State:     openable id, EAssetState; written for every openable when the recording ends
+ *
+ * When the recording ends, the transforms of all the items are written again, so applying every
+ * Transform and State record of a file gives the final state of the kitchen.
+ */
+namespace KitchenRecording
+{
+	static const uint32 Magic = 0x4345524B; // "KREC" read as little endian
+	static const uint16 Version = 2;
+
+	enum class ERecordType : uint8
+	{
+		Name = 1,
+		Frame = 2,
+		Event = 3,
+		Transform = 4,
+		Input = 5,
+		State = 6
+	};
+
+	enum class ERecordedEvent : uint8
+	{
+		Pick = 1,
+		Drop = 2,
+		Open = 3,
+		Close = 4,
+		SwitchHand = 5,
+		RotationAxis = 6
+	};
+
+	//Axes of the character, in the order of an Input record mask
+	enum EInputAxis
+	{
+		MoveForwardAxis, MoveRightAxis, RotateObjectAxis, MoveItemYAxis, MoveItemZAxis, NumInputAxes
+	};
+
+	//Actions pressed by the player, as bits of an Input record
+	enum EInputAction
+	{
+		ClickAction = 1 << 0,
+		SwitchHandAction = 1 << 1,
+		SwitchRotationAxisAction = 1 << 2
+	};
+
+	//Bit of the first control rotation component (pitch, yaw, roll) in an Input record mask
+	static const int32 ControlRotationBit = NumInputAxes;
+
+	//Quantization of the input axes
+	static const float InputScale = 1000.f;
+
+	//Quantization of the transforms
+	static const float LocationScale = 100.f;
+	static const float RotationScale = 100.f;
+
+	//Order of the components in a Transform record mask
+	enum ETransformComponent
+	{
+		LocationX, LocationY, LocationZ, Pitch, Yaw, Roll, NumTransformComponents
+	};
+
+	//Quantized transform, as written in the Transform records
+	struct FQuantizedTransform
+	{
+		int32 Values[NumTransformComponents];
+
+		FQuantizedTransform()
+		{
+			FMemory::Memzero(Values);
+		}
+
+		FQuantizedTransform(const FVector& Location, const FRotator& Rotation)
+		{
+			Values[LocationX] = FMath::RoundToInt(Location.X * LocationScale);
+			Values[LocationY] = FMath::RoundToInt(Location.Y * LocationScale);
+			Values[LocationZ] = FMath::RoundToInt(Location.Z * LocationScale);
+			Values[Pitch] = FMath::RoundToInt(Rotation.Pitch * RotationScale);
+			Values[Yaw] = FMath::RoundToInt(Rotation.Yaw * RotationScale);
+			Values[Roll] = FMath::RoundToInt(Rotation.Roll * RotationScale);
+		}
+
+		FVector GetLocation() const
+		{
+			return FVector(Values[LocationX], Values[LocationY], Values[LocationZ]) / LocationScale;
+		}
+
+		FRotator GetRotation() const
+		{
+			return FRotator(Values[Pitch] / RotationScale, Values[Yaw] / RotationScale, Values[Roll] / RotationScale);
+		}
+	};
+
+	FORCEINLINE void WriteByte(TArray<uint8>& Buffer, uint8 Value)
+	{
+		Buffer.Add(Value);
+	}
+
+	FORCEINLINE void WriteVarUInt(TArray<uint8>& Buffer, uint64 Value)
+	{
+		while (Value >= 0x80)
+		{
+			Buffer.Add(static_cast<uint8>(Value | 0x80));
+			Value >>= 7;
+		}
+		Buffer.Add(static_cast<uint8>(Value));
+	}
+
+	FORCEINLINE void WriteVarInt(TArray<uint8>& Buffer, int64 Value)
+	{
+		//Zigzag, so small negative values stay short
+		WriteVarUInt(Buffer, (static_cast<uint64>(Value) << 1) ^ static_cast<uint64>(Value >> 63));
+	}
+
+	FORCEINLINE void WriteString(TArray<uint8>& Buffer, const FString& Value)
+	{
+		FTCHARToUTF8 Converted(*Value);
+		WriteVarUInt(Buffer, Converted.Length());
+		Buffer.Append(reinterpret_cast<const uint8*>(Converted.Get()), Converted.Length());
+	}
+
+	//Reads the records of a recording held in memory; every read fails once the data is exhausted or corrupt
+	struct FReader
+	{
+		const uint8* Data;
+		int32 Size;
+		int32 Offset;
+		bool bError;
+
+		FReader(const TArray<uint8>& Buffer)
+			: Data(Buffer.GetData())
+			, Size(Buffer.Num())
+			, Offset(0)
+			, bError(false)
+		{
+		}
+
+		bool AtEnd() const { return bError || Offset >= Size; }
+
+		uint8 ReadByte()
+		{
+			if (Offset >= Size)
+			{
+				bError = true;
+				return 0;
+			}
+			return Data[Offset++];
+		}
+
+		uint64 ReadVarUInt()
+		{
+			uint64 Value = 0;
+			for (int32 Shift = 0; Shift < 64; Shift += 7)
+			{
+				const uint8 Byte = ReadByte();
+				Value |= static_cast<uint64>(Byte & 0x7F) << Shift;
+				if (!(Byte & 0x80))
+				{
+					return Value;
+				}
+			}
+			bError = true;
+			return 0;
+		}
+
+		int64 ReadVarInt()
+		{
+			const uint64 Value = ReadVarUInt();
+			return static_cast<int64>(Value >> 1) ^ -static_cast<int64>(Value & 1);
+		}
+
+		FString ReadString()
+		{
+			const int32 Length = static_cast<int32>(ReadVarUInt());
+			if (bError || Length < 0 || Offset + Length > Size)
+			{
+				bError = true;
+				return FString();
+			}
+			TArray<ANSICHAR> Chars;
+			Chars.Append(reinterpret_cast<const ANSICHAR*>(Data + Offset), Length);
+			Chars.Add(0);
+			Offset += Length;
+			return FString(UTF8_TO_TCHAR(Chars.GetData()));
+		}
+
+		//Skips the body of a record whose type was just read; an unknown type is an error
+		void SkipRecord(ERecordType Type)
+		{
+			switch (Type)
+			{
+			case ERecordType::Name:
+			{
+				ReadVarUInt();
+				const int32 Length = static_cast<int32>(ReadVarUInt());
+				if (Length < 0 || Offset + Length > Size)
+				{
+					bError = true;
+					return;
+				}
+				Offset += Length;
+				break;
+			}
+			case ERecordType::Frame:
+				ReadVarUInt();
+				ReadVarUInt();
+				break;
+			case ERecordType::Event:
+				ReadByte();
+				ReadVarUInt();
+				ReadVarUInt();
+				ReadVarInt();
+				break;
+			case ERecordType::Transform:
+			case ERecordType::Input:
+			{
+				//One signed value per bit of the mask
+				ReadVarUInt();
+				if (Type == ERecordType::Input)
+				{
+					ReadByte();
+				}
+				for (uint64 Mask = ReadVarUInt(); Mask != 0 && !bError; Mask &= Mask - 1)
+				{
+					ReadVarInt();
+				}
+				break;
+			}
+			case ERecordType::State:
+				ReadVarUInt();
+				ReadByte();
+				break;
+			default:
+				bError = true;
+				break;
+			}
+		}
+
+		//Checks the magic and the version at the start of the file
+		bool ReadHeader()
+		{
+			uint32 FileMagic = 0;
+			for (int32 Index = 0; Index < 4; Index++)
+			{
+				FileMagic |= static_cast<uint32>(ReadByte()) << (8 * Index);
+			}
+			//Two statements, the order of the reads inside one expression is not defined
+			const uint16 VersionLow = ReadByte();
+			const uint16 VersionHigh = ReadByte();
+			const uint16 FileVersion = static_cast<uint16>(VersionLow | (VersionHigh << 8));
+			return !bError && FileMagic == Magic && FileVersion == Version;
+		}
+	};
+}
@@ -0,0 +1,336 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Kitchen.h"
+#include "RunEpisodesCommandlet.h"
+#include "Json.h"
+
+URunEpisodesCommandlet::URunEpisodesCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = false;
+	LogToConsole = true;
+
+	bPin = true;
+}
+
+//Running game of an episode
+struct FRunningEpisode
+{
+	int32 Episode;
+	int32 Slot;
+	FProcHandle Handle;
+	double StartSeconds;
+};
+
+int32 URunEpisodesCommandlet::Main(const FString& Params)
+{
+	FString SpecPath;
+	if (!FParse::Value(*Params, TEXT("Episodes="), SpecPath))
+	{
+		UE_LOG(LogTemp, Error, TEXT("RunEpisodes needs -Episodes=<file.json>"));
+		return 1;
+	}
+	SpecPath = FPaths::ConvertRelativePathToFull(SpecPath);
+
+	TArray<FEpisodeSpec> Episodes;
+	if (!LoadEpisodes(SpecPath, Episodes) || Episodes.Num() == 0)
+	{
+		UE_LOG(LogTemp, Error, TEXT("No episode could be read from %s"), *SpecPath);
+		return 1;
+	}
+
+	FString OutDir;
+	if (!FParse::Value(*Params, TEXT("Out="), OutDir))
+	{
+		OutDir = FPaths::GameSavedDir() / TEXT("Episodes") / FDateTime::Now().ToString();
+	}
+	OutDir = FPaths::ConvertRelativePathToFull(OutDir);
+
+	const int32 NumLogicalCores = FPlatformMisc::NumberOfCoresIncludingHyperthreads();
+	int32 NumJobs = NumLogicalCores;
+	FParse::Value(*Params, TEXT("Jobs="), NumJobs);
+	NumJobs = FMath::Clamp(NumJobs, 1, Episodes.Num());
+
+	float Timeout = 0.f;
+	FParse::Value(*Params, TEXT("Timeout="), Timeout);
+	bPin = !FParse::Param(*Params, TEXT("NoPin"));
+
+	//Without a packaged game the editor binary running this commandlet plays the episodes
+	if (FParse::Value(*Params, TEXT("Executable="), Executable))
+	{
+		Executable = FPaths::ConvertRelativePathToFull(Executable);
+		BaseArgs.Empty();
+	}
+	else
+	{
+		Executable = FPaths::ConvertRelativePathToFull(FPlatformProcess::BaseDir()) / FPlatformProcess::ExecutableName(false);
+		BaseArgs = FString::Printf(TEXT("\"%s\""), *FPaths::ConvertRelativePathToFull(FPaths::GetProjectFilePath()));
+	}
+
+	//Every game gets the same share of the machine, the engine sizes its worker threads to what it can use
+	const int32 NumCoresPerJob = FMath::Max(NumLogicalCores / NumJobs, 1);
+
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	PlatformFile.CreateDirectoryTree(*OutDir);
+	UE_LOG(LogTemp, Display, TEXT("Running %d episodes, %d at a time on %d cores each, into %s"), Episodes.Num(), NumJobs, NumCoresPerJob, *OutDir);
+
+	TArray<FEpisodeResult> Results;
+	Results.SetNumZeroed(Episodes.Num());
+	TArray<FRunningEpisode> Running;
+	TArray<bool> FreeSlots;
+	FreeSlots.Init(true, NumJobs);
+
+	const double StartSeconds = FPlatformTime::Seconds();
+	int32 NextEpisode = 0;
+	while (NextEpisode < Episodes.Num() || Running.Num() > 0)
+	{
+		//Free slots take the next episodes
+		for (int32 Slot = 0; Slot < NumJobs && NextEpisode < Episodes.Num(); Slot++)
+		{
+			if (!FreeSlots[Slot])
+			{
+				continue;
+			}
+
+			const FEpisodeSpec& Episode = Episodes[NextEpisode];
+			const FString EpisodeDir = OutDir / Episode.Name;
+			PlatformFile.CreateDirectoryTree(*EpisodeDir);
+
+			FEpisodeResult& Result = Results[NextEpisode];
+			Result.FirstCore = (Slot * NumCoresPerJob) % NumLogicalCores;
+			Result.NumCores = NumCoresPerJob;
+
+			FRunningEpisode Started;
+			Started.Episode = NextEpisode;
+			Started.Slot = Slot;
+			Started.Handle = LaunchEpisode(Episode, EpisodeDir, Result.FirstCore, Result.NumCores);
+			Started.StartSeconds = FPlatformTime::Seconds();
+			NextEpisode++;
+
+			if (!Started.Handle.IsValid())
+			{
+				UE_LOG(LogTemp, Error, TEXT("Could not start the episode %s"), *Episode.Name);
+				Result.ReturnCode = -1;
+				continue;
+			}
+			Running.Add(Started);
+			FreeSlots[Slot] = false;
+		}
+
+		FPlatformProcess::Sleep(0.1f);
+
+		for (int32 Index = Running.Num() - 1; Index >= 0; Index--)
+		{
+			FRunningEpisode& Episode = Running[Index];
+			FEpisodeResult& Result = Results[Episode.Episode];
+			const double WallSeconds = FPlatformTime::Seconds() - Episode.StartSeconds;
+
+			if (FPlatformProcess::IsProcRunning(Episode.Handle))
+			{
+				if (Timeout <= 0.f || WallSeconds < Timeout)
+				{
+					continue;
+				}
+				FPlatformProcess::TerminateProc(Episode.Handle, true);
+				Result.bTimedOut = true;
+			}
+
+			int32 ReturnCode = -1;
+			FPlatformProcess::GetProcReturnCode(Episode.Handle, &ReturnCode);
+			FPlatformProcess::CloseProc(Episode.Handle);
+
+			const FEpisodeSpec& Spec = Episodes[Episode.Episode];
+			Result.ReturnCode = ReturnCode;
+			Result.WallSeconds = WallSeconds;
+			Result.SimulatedSeconds = Result.bTimedOut ? 0.0 : ReadSimulatedSeconds(Spec, OutDir / Spec.Name);
+
+			UE_LOG(LogTemp, Display, TEXT("Episode %s %s with code %d: %.1f s simulated in %.1f s (%d of %d done)"),
+				*Spec.Name, Result.bTimedOut ? TEXT("timed out") : TEXT("ended"), ReturnCode, Result.SimulatedSeconds, WallSeconds,
+				NextEpisode - Running.Num() + 1, Episodes.Num());
+
+			FreeSlots[Episode.Slot] = true;
+			Running.RemoveAtSwap(Index);
+		}
+	}
+	const double TotalWallSeconds = FPlatformTime::Seconds() - StartSeconds;
+
+	double TotalSimulatedSeconds = 0.0;
+	int32 NumFailed = 0;
+	FString Csv = TEXT("Episode,Return Code,Timed Out,First Core,Cores,Wall Duration (s),Simulated Duration (s),Speedup\n");
+	for (int32 Index = 0; Index < Episodes.Num(); Index++)
+	{
+		const FEpisodeResult& Result = Results[Index];
+		Csv += FString::Printf(TEXT("%s,%d,%d,%d,%d,%.3f,%.3f,%.2f\n"), *Episodes[Index].Name, Result.ReturnCode, Result.bTimedOut ? 1 : 0,
+			Result.FirstCore, Result.NumCores, Result.WallSeconds, Result.SimulatedSeconds,
+			Result.WallSeconds > 0.0 ? Result.SimulatedSeconds / Result.WallSeconds : 0.0);
+
+		TotalSimulatedSeconds += Result.SimulatedSeconds;
+		NumFailed += Result.ReturnCode != 0 || Result.bTimedOut ? 1 : 0;
+	}
+	const double Throughput = TotalWallSeconds > 0.0 ? TotalSimulatedSeconds / TotalWallSeconds : 0.0;
+	Csv += FString::Printf(TEXT("Total,,,,%d,%.3f,%.3f,%.2f\n"), NumJobs * NumCoresPerJob, TotalWallSeconds, TotalSimulatedSeconds, Throughput);
+
+	const FString CsvPath = OutDir / TEXT("Episodes.csv");
+	if (!FFileHelper::SaveStringToFile(Csv, *CsvPath))
+	{
+		UE_LOG(LogTemp, Error, TEXT("Could not write %s"), *CsvPath);
+	}
+
+	UE_LOG(LogTemp, Display, TEXT("%d episodes, %d failed: %.1f s simulated in %.1f s, %.2f simulated s per wall s"),
+		Episodes.Num(), NumFailed, TotalSimulatedSeconds, TotalWallSeconds, Throughput);
+	return NumFailed > 0 ? 1 : 0;
+}
+
+bool URunEpisodesCommandlet::LoadEpisodes(const FString& FilePath, TArray<FEpisodeSpec>& OutEpisodes) const
+{
+	FString Text;
+	if (!FFileHelper::LoadFileToString(Text, *FilePath))
+	{
+		return false;
+	}
+
+	TSharedPtr<FJsonObject> Root;
+	const TArray<TSharedPtr<FJsonValue>>* Entries = nullptr;
+	if (!FJsonSerializer::Deserialize(TJsonReaderFactory<>::Create(Text), Root) || !Root.IsValid() || !Root->TryGetArrayField(TEXT("Episodes"), Entries))
+	{
+		UE_LOG(LogTemp, Error, TEXT("%s has no Episodes array"), *FilePath);
+		return false;
+	}
+
+	//Paths of the list are relative to it
+	const FString BaseDir = FPaths::GetPath(FilePath);
+	TSet<FString> Names;
+	for (const TSharedPtr<FJsonValue>& Entry : *Entries)
+	{
+		const TSharedPtr<FJsonObject> Object = Entry->AsObject();
+		if (!Object.IsValid())
+		{
+			continue;
+		}
+
+		FEpisodeSpec& Episode = OutEpisodes[OutEpisodes.AddDefaulted()];
+		double Number = 0.0;
+		Object->TryGetStringField(TEXT("Name"), Episode.Name);
+		Object->TryGetStringField(TEXT("Map"), Episode.Map);
+		Object->TryGetStringField(TEXT("Scenario"), Episode.Scenario);
+		Object->TryGetStringField(TEXT("Args"), Episode.Args);
+		Episode.bBenchmark = false;
+		Object->TryGetBoolField(TEXT("Benchmark"), Episode.bBenchmark);
+		Episode.bRecord = true;
+		Object->TryGetBoolField(TEXT("Record"), Episode.bRecord);
+		Episode.Duration = Object->TryGetNumberField(TEXT("Duration"), Number) ? static_cast<float>(Number) : 0.f;
+		Episode.Step = Object->TryGetNumberField(TEXT("Step"), Number) ? static_cast<float>(Number) : 0.f;
+		if (Object->TryGetStringField(TEXT("Replay"), Episode.Replay) && FPaths::IsRelative(Episode.Replay))
+		{
+			Episode.Replay = FPaths::ConvertRelativePathToFull(BaseDir, Episode.Replay);
+		}
+
+		//Every episode needs its own directory
+		if (Episode.Name.IsEmpty() || Names.Contains(Episode.Name))
+		{
+			Episode.Name = FString::Printf(TEXT("%sEpisode%03d"), *Episode.Name, OutEpisodes.Num() - 1);
+		}
+		Names.Add(Episode.Name);
+
+		if (Episode.Duration <= 0.f && Episode.Replay.IsEmpty() && !Episode.bBenchmark)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("Episode %s has no duration and no input which ends it, it only ends with -Timeout"), *Episode.Name);
+		}
+	}
+	return true;
+}
+
+FProcHandle URunEpisodesCommandlet::LaunchEpisode(const FEpisodeSpec& Episode, const FString& EpisodeDir, int32 FirstCore, int32 NumCores) const
+{
+	FString Args = BaseArgs;
+	if (!Episode.Map.IsEmpty())
+	{
+		Args += TEXT(" ") + Episode.Map;
+	}
+	if (!BaseArgs.IsEmpty())
+	{
+		Args += TEXT(" -game");
+	}
+	Args += TEXT(" -nullrhi -nosound -nosplash -unattended");
+	Args += Episode.Step > 0.f ? FString::Printf(TEXT(" -KitchenFixedStep=%f"), Episode.Step) : FString(TEXT(" -KitchenFixedStep"));
+
+	//Everything the game writes goes to the directory of the episode; a replay writes its metrics instead of the fixed step
+	Args += FString::Printf(TEXT(" -abslog=\"%s\""), *(EpisodeDir / TEXT("Episode.log")));
+	Args += FString::Printf(TEXT(" -KitchenEventDir=\"%s\""), *EpisodeDir);
+	Args += FString::Printf(TEXT(" -FixedStepCsv=\"%s\" -ReplayCsv=\"%s\""), *(EpisodeDir / TEXT("Metrics.csv")), *(EpisodeDir / TEXT("Metrics.csv")));
+	if (Episode.bRecord)
+	{
+		Args += FString::Printf(TEXT(" -KitchenRecord=\"%s\""), *(EpisodeDir / TEXT("Episode.krec")));
+	}
+	if (!Episode.Scenario.IsEmpty())
+	{
+		Args += FString::Printf(TEXT(" -KitchenScenario=%s"), *Episode.Scenario);
+	}
+	if (!Episode.Replay.IsEmpty())
+	{
+		Args += FString::Printf(TEXT(" -KitchenReplay=\"%s\""), *Episode.Replay);
+	}
+	if (Episode.bBenchmark)
+	{
+		Args += FString::Printf(TEXT(" -KitchenBenchmark -BenchmarkCsv=\"%s\""), *(EpisodeDir / TEXT("Benchmark.csv")));
+	}
+	if (Episode.Duration > 0.f)
+	{
+		Args += FString::Printf(TEXT(" -KitchenDuration=%f"), Episode.Duration);
+	}
+	if (!Episode.Args.IsEmpty())
+	{
+		Args += TEXT(" ") + Episode.Args;
+	}
+
+	FString Url = Executable;
+#if PLATFORM_LINUX
+	//Started through taskset, so every thread of the game inherits the cores from its first instruction
+	if (bPin && FPaths::FileExists(TEXT("/usr/bin/taskset")))
+	{
+		Args = FString::Printf(TEXT("-c %d-%d \"%s\" %s"), FirstCore, FirstCore + NumCores - 1, *Executable, *Args);
+		Url = TEXT("/usr/bin/taskset");
+	}
+#endif
+
+	UE_LOG(LogTemp, Log, TEXT("Starting episode %s: %s %s"), *Episode.Name, *Url, *Args);
+	FProcHandle Handle = FPlatformProcess::CreateProc(*Url, *Args, false, true, true, nullptr, 0, *EpisodeDir, nullptr);
+
+#if PLATFORM_WINDOWS
+	//Applies to every thread of the game, including the ones it already started
+	if (bPin && Handle.IsValid())
+	{
+		if (FirstCore + NumCores <= 64)
+		{
+			const uint64 Mask = (NumCores >= 64 ? ~0ull : ((1ull << NumCores) - 1)) << FirstCore;
+			::SetProcessAffinityMask(Handle.Get(), static_cast<DWORD_PTR>(Mask));
+		}
+		else
+		{
+			UE_LOG(LogTemp, Warning, TEXT("Episode %s is not pinned, cores past the first 64 are in another processor group"), *Episode.Name);
+		}
+	}
+#endif
+	return Handle;
+}
+
+double URunEpisodesCommandlet::ReadSimulatedSeconds(const FEpisodeSpec& Episode, const FString& EpisodeDir) const
+{
+	TArray<FString> Lines;
+	if (FFileHelper::LoadANSITextFileToStrings(*(EpisodeDir / TEXT("Metrics.csv")), nullptr, Lines))
+	{
+		for (const FString& Line : Lines)
+		{
+			FString Metric;
+			FString Value;
+			if (Line.Split(TEXT(","), &Metric, &Value) && (Metric == TEXT("Simulated Duration (s)") || Metric == TEXT("Recorded Duration (s)")))
+			{
+				return FCString::Atod(*Value);
+			}
+		}
+	}
+
+	//A replay cut by the duration writes no metrics, it played exactly the requested time
+	return Episode.Duration;
+}
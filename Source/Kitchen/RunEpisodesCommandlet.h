@@ -0,0 +1,84 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "Commandlets/Commandlet.h"
+#include "RunEpisodesCommandlet.generated.h"
+
+//One episode of the episode list
+struct FEpisodeSpec
+{
+	//Name of the episode, also the name of its output directory
+	FString Name;
+
+	//Map to open, the default map of the project if empty
+	FString Map;
+
+	//Save slot of the starting state of the kitchen, the state of the map if empty
+	FString Scenario;
+
+	//Recording whose input is played, none if empty
+	FString Replay;
+
+	//Input given by the scripted benchmark walkthrough
+	bool bBenchmark;
+
+	//Records the episode to Episode.krec
+	bool bRecord;
+
+	//Game time after which the episode ends, 0 lets the replay or the benchmark end it
+	float Duration;
+
+	//Fixed time step, 0 for the configured one
+	float Step;
+
+	//Further arguments given to the game
+	FString Args;
+};
+
+//How an episode ended
+struct FEpisodeResult
+{
+	int32 ReturnCode;
+	bool bTimedOut;
+	double WallSeconds;
+	double SimulatedSeconds;
+	int32 FirstCore;
+	int32 NumCores;
+};
+
+/**
+ * Runs a list of episodes as concurrent headless games, each pinned to its own cores, and collects
+ * their recordings, metrics and logs into one directory. Run from the editor binary:
+ *   UE4Editor-Cmd.exe Kitchen.uproject -run=RunEpisodes -Episodes=<file.json> [-Out=<dir>] [-Jobs=N] [-Timeout=<s>] [-NoPin] [-Executable=<game>]
+ * The episode file holds {"Episodes": [{"Name", "Map", "Scenario", "Replay", "Benchmark", "Record", "Duration", "Step", "Args"}]},
+ * paths in it are relative to the file. Every episode runs in fixed step mode with -nullrhi; the
+ * summary in Episodes.csv gives the simulated time of each episode and the aggregate throughput.
+ * -Jobs defaults to one game per logical core, -Executable runs a packaged game instead of the editor.
+ */
+UCLASS()
+class URunEpisodesCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	URunEpisodesCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+
+private:
+	//Reads the episode list; returns false if the file could not be read
+	bool LoadEpisodes(const FString& FilePath, TArray<FEpisodeSpec>& OutEpisodes) const;
+
+	//Starts the game of an episode on the given cores
+	FProcHandle LaunchEpisode(const FEpisodeSpec& Episode, const FString& EpisodeDir, int32 FirstCore, int32 NumCores) const;
+
+	//Simulated time written by the game to Metrics.csv, the requested duration if there is none
+	double ReadSimulatedSeconds(const FEpisodeSpec& Episode, const FString& EpisodeDir) const;
+
+	//Game binary and the arguments it needs before the episode ones
+	FString Executable;
+	FString BaseArgs;
+
+	bool bPin;
+};
@@ -0,0 +1,259 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Kitchen.h"
+#include "SettleManager.h"
+#include "InteractableComponent.h"
+#include "KitchenWorldManager.h"
+#include "InteractableRegistry.h"
+
+ASettleManager::ASettleManager()
+{
+	//Velocities are read once the simulation of the frame is done
+	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.TickGroup = TG_PostPhysics;
+
+	BaseSleepEnergy = 12.5f;
+	ReferenceMass = 0.5f;
+	SettleTime = 0.3f;
+	LockDelay = 10.f;
+	LockCheckInterval = 1.f;
+	UnlockMargin = 2.f;
+
+	NumLocked = 0;
+	LockCheckTime = 0.f;
+}
+
+ASettleManager* ASettleManager::Get(UWorld* World)
+{
+	return GetWorldManager<ASettleManager>(World);
+}
+
+void ASettleManager::Track(UInteractableComponent* Item)
+{
+	UStaticMeshComponent* Mesh = Item ? Item->GetMesh() : nullptr;
+	if (!Mesh || !Mesh->IsSimulatingPhysics())
+	{
+		return;
+	}
+
+	FSettleState* State = Bodies.Find(Mesh);
+	if (!State)
+	{
+		State = &Bodies.Add(Mesh);
+		State->bLocked = false;
+
+		Item->EnableWakeEvents();
+		Mesh->OnComponentWake.AddUniqueDynamic(this, &ASettleManager::OnItemWake);
+		Mesh->OnComponentSleep.AddUniqueDynamic(this, &ASettleManager::OnItemSleep);
+	}
+	else if (State->bLocked)
+	{
+		//Picked while locked, it simulates again since it was dropped
+		State->bLocked = false;
+		Mesh->SetNotifyRigidBodyCollision(false);
+		NumLocked--;
+	}
+
+	ComputeThresholds(Item, *State);
+	State->Item = Item;
+	State->RestTime = 0.f;
+	State->SleepStartTime = GetWorld()->GetTimeSeconds();
+	State->bAwake = Mesh->RigidBodyIsAwake();
+	Item->SetNetDormant(!State->bAwake);
+	if (State->bAwake)
+	{
+		AwakeBodies.AddUnique(Mesh);
+	}
+	else
+	{
+		//Put to sleep by the caller, like the items of a loaded scenario
+		AwakeBodies.Remove(Mesh);
+	}
+	UpdateStats();
+}
+
+void ASettleManager::ComputeThresholds(UInteractableComponent* Item, FSettleState& State) const
+{
+	UStaticMeshComponent* Mesh = Item->GetMesh();
+	const float Size = FMath::Max(Item->LocalBounds.GetSize().GetMax() * Mesh->GetComponentScale().GetMax(), 1.f);
+	const float Mass = Mesh->GetMass() > 0.f ? Mesh->GetMass() : ReferenceMass;
+
+	//Bigger items may keep more energy when resting, light ones jitter more and are put to sleep sooner
+	const float SizeScale = FMath::Square(Size / 10.f);
+	const float MassScale = FMath::Clamp(FMath::Sqrt(ReferenceMass / Mass), 0.5f, 2.f);
+	const float SleepEnergy = BaseSleepEnergy * SizeScale * MassScale;
+
+	//Same energy expressed as a speed, and as the turning speed moving the tips of the item that fast
+	State.LinearThreshold = FMath::Sqrt(2.f * SleepEnergy);
+	State.AngularThreshold = FMath::RadiansToDegrees(State.LinearThreshold / (0.5f * Size));
+}
+
+void ASettleManager::Tick(float DeltaSeconds)
+{
+	SCOPE_CYCLE_COUNTER(STAT_KitchenSettle);
+
+	Super::Tick(DeltaSeconds);
+
+	for (int32 Index = AwakeBodies.Num() - 1; Index >= 0; Index--)
+	{
+		UPrimitiveComponent* Body = AwakeBodies[Index].Get();
+		FSettleState* State = Body ? Bodies.Find(Body) : nullptr;
+		if (!State)
+		{
+			AwakeBodies.RemoveAtSwap(Index);
+			continue;
+		}
+
+		//Held items are moved by the hand, not by physics
+		if (!Body->IsSimulatingPhysics())
+		{
+			continue;
+		}
+
+		//Awake items are the only ones physics moves, keep them up to date in the spatial queries
+		State->Item->NotifyMoved();
+
+		const bool bResting = Body->GetPhysicsLinearVelocity().Size() < State->LinearThreshold
+			&& Body->GetPhysicsAngularVelocity().Size() < State->AngularThreshold;
+		State->RestTime = bResting ? State->RestTime + DeltaSeconds : 0.f;
+
+		if (State->RestTime > SettleTime)
+		{
+			//Do not wait for the solver to notice, the sleep callback may come a frame later
+			Body->PutRigidBodyToSleep();
+			State->Item->SetNetDormant(true);
+			State->bAwake = false;
+			State->SleepStartTime = GetWorld()->GetTimeSeconds();
+			AwakeBodies.RemoveAtSwap(Index);
+		}
+	}
+
+	LockCheckTime += DeltaSeconds;
+	if (LockCheckTime >= LockCheckInterval)
+	{
+		LockCheckTime = 0.f;
+		LockSleepingItems();
+	}
+	UpdateStats();
+}
+
+void ASettleManager::LockSleepingItems()
+{
+	const float Now = GetWorld()->GetTimeSeconds();
+	const bool bIsClient = GetNetMode() == NM_Client;
+	for (auto It = Bodies.CreateIterator(); It; ++It)
+	{
+		UPrimitiveComponent* Body = It.Key().Get();
+		FSettleState& State = It.Value();
+		if (!Body)
+		{
+			//The item left with its level
+			if (State.bLocked)
+			{
+				NumLocked--;
+			}
+			It.RemoveCurrent();
+			continue;
+		}
+
+		//Clients follow the bodies replicated by the server, a locked body would ignore them
+		if (LockDelay <= 0.f || bIsClient || State.bAwake || State.bLocked || !Body->IsSimulatingPhysics() || Now - State.SleepStartTime < LockDelay)
+		{
+			continue;
+		}
+
+		//Knocked by another body since it was put to sleep, and the wake event has not come yet
+		if (Body->RigidBodyIsAwake())
+		{
+			OnItemWake(Body, NAME_None);
+			continue;
+		}
+
+		//Keep the collision, only stop simulating; a hit gives the item back to physics
+		Body->SetSimulatePhysics(false);
+		Body->SetNotifyRigidBodyCollision(true);
+		Body->OnComponentHit.AddUniqueDynamic(this, &ASettleManager::OnLockedItemHit);
+		State.bLocked = true;
+		NumLocked++;
+	}
+}
+
+void ASettleManager::Unlock(UPrimitiveComponent* Body)
+{
+	FSettleState* State = Body ? Bodies.Find(Body) : nullptr;
+	if (!State || !State->bLocked)
+	{
+		return;
+	}
+
+	State->bLocked = false;
+	NumLocked--;
+	Body->SetNotifyRigidBodyCollision(false);
+	Body->SetSimulatePhysics(true);
+
+	State->bAwake = true;
+	State->RestTime = 0.f;
+	State->Item->SetNetDormant(false);
+	AwakeBodies.AddUnique(Body);
+	UpdateStats();
+}
+
+void ASettleManager::UnlockTouching(const UPrimitiveComponent* MovingBody)
+{
+	const AInteractableRegistry* Registry = AInteractableRegistry::FindInWorld(GetWorld());
+	if (!MovingBody || !Registry || NumLocked == 0)
+	{
+		return;
+	}
+
+	//A locked item does not simulate, the body would move away from under it or push through it without a hit
+	const FBox MovingBox = MovingBody->Bounds.GetBox().ExpandBy(UnlockMargin);
+	//Items resting in or on the body have their centre within its bounds sphere
+	TArray<FInteractableQueryResult> Nearby;
+	Registry->FindInRadius(MovingBody->Bounds.Origin, MovingBody->Bounds.SphereRadius + UnlockMargin, Nearby);
+	for (const FInteractableQueryResult& Result : Nearby)
+	{
+		UStaticMeshComponent* Mesh = Result.Interactable->GetMesh();
+		const FSettleState* State = Mesh && Mesh != MovingBody ? Bodies.Find(Mesh) : nullptr;
+		if (State && State->bLocked && MovingBox.Intersect(Mesh->Bounds.GetBox()))
+		{
+			Unlock(Mesh);
+		}
+	}
+}
+
+void ASettleManager::OnItemWake(UPrimitiveComponent* WakingComponent, FName BoneName)
+{
+	FSettleState* State = Bodies.Find(WakingComponent);
+	if (State && !State->bLocked)
+	{
+		State->bAwake = true;
+		State->RestTime = 0.f;
+		State->Item->SetNetDormant(false);
+		AwakeBodies.AddUnique(WakingComponent);
+	}
+}
+
+void ASettleManager::OnItemSleep(UPrimitiveComponent* SleepingComponent, FName BoneName)
+{
+	FSettleState* State = Bodies.Find(SleepingComponent);
+	if (State && State->bAwake)
+	{
+		State->bAwake = false;
+		State->SleepStartTime = GetWorld()->GetTimeSeconds();
+		State->Item->SetNetDormant(true);
+		AwakeBodies.RemoveSwap(SleepingComponent);
+	}
+}
+
+void ASettleManager::OnLockedItemHit(UPrimitiveComponent* HitComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, FVector NormalImpulse, const FHitResult& Hit)
+{
+	Unlock(HitComponent);
+}
+
+void ASettleManager::UpdateStats()
+{
+	SET_DWORD_STAT(STAT_KitchenSettlingItems, GetNumAwake());
+	SET_DWORD_STAT(STAT_KitchenSleepingItems, GetNumSleeping());
+	SET_DWORD_STAT(STAT_KitchenLockedItems, GetNumLocked());
+}
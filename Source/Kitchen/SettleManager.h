@@ -0,0 +1,119 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "GameFramework/Info.h"
+#include "SettleManager.generated.h"
+
+class UInteractableComponent;
+
+/**
+ * Brings items to rest quickly and keeps them there. Each item gets sleep thresholds scaled by
+ * its size and mass; once it moves slower than them for a moment it is put to sleep instead of
+ * waiting for the solver. Items asleep for a long time are locked: they stop simulating until a
+ * body hits them, a character picks them or the drawer or door they rest in starts moving. Only awake items are checked every frame, the
+ * others are followed through the physics wake and sleep callbacks.
+ */
+UCLASS(config = Game)
+class KITCHEN_API ASettleManager : public AInfo
+{
+	GENERATED_BODY()
+
+public:
+	ASettleManager();
+
+	//Returns the settle manager of the world, spawning it the first time it is requested
+	static ASettleManager* Get(UWorld* World);
+
+	// Called every frame, after physics
+	virtual void Tick(float DeltaSeconds) override;
+
+	//Starts following an item; called when it is registered, every time it is dropped and when it is teleported
+	void Track(UInteractableComponent* Item);
+
+	//Gives a locked item back to physics
+	void Unlock(UPrimitiveComponent* Body);
+
+	//Gives back to physics the locked items touching a body about to move, like a drawer being opened
+	void UnlockTouching(const UPrimitiveComponent* MovingBody);
+
+	//Number of followed items which are awake, asleep and locked
+	int32 GetNumAwake() const { return AwakeBodies.Num(); }
+	int32 GetNumSleeping() const { return Bodies.Num() - AwakeBodies.Num() - NumLocked; }
+	int32 GetNumLocked() const { return NumLocked; }
+
+	//Items currently moving under physics
+	const TArray<TWeakObjectPtr<UPrimitiveComponent>>& GetAwakeBodies() const { return AwakeBodies; }
+
+	//Mass-normalized kinetic energy under which a 10 cm item of ReferenceMass counts as resting, in cm2/s2
+	UPROPERTY(config)
+	float BaseSleepEnergy;
+
+	//Mass of the reference item, in kg
+	UPROPERTY(config)
+	float ReferenceMass;
+
+	//Seconds an item has to stay under its thresholds before it is put to sleep
+	UPROPERTY(config)
+	float SettleTime;
+
+	//Seconds an item has to sleep before it is locked, 0 never locks
+	UPROPERTY(config)
+	float LockDelay;
+
+	//Seconds between two checks of the sleeping items
+	UPROPERTY(config)
+	float LockCheckInterval;
+
+	//Distance around the bounds of a moving body within which locked items are given back to physics, in cm
+	UPROPERTY(config)
+	float UnlockMargin;
+
+private:
+	struct FSettleState
+	{
+		//Interactable of the item, told when physics moves it
+		UInteractableComponent* Item;
+
+		//Speeds under which the item counts as resting, cm/s and deg/s
+		float LinearThreshold;
+		float AngularThreshold;
+
+		//Time spent under the thresholds while awake
+		float RestTime;
+
+		//World time at which the item fell asleep
+		float SleepStartTime;
+
+		bool bAwake;
+		bool bLocked;
+	};
+
+	//Computes the thresholds of an item from its bounds and mass
+	void ComputeThresholds(UInteractableComponent* Item, FSettleState& State) const;
+
+	//Locks the items asleep for longer than the lock delay
+	void LockSleepingItems();
+
+	//Physics callbacks of the followed items
+	UFUNCTION()
+	void OnItemWake(UPrimitiveComponent* WakingComponent, FName BoneName);
+
+	UFUNCTION()
+	void OnItemSleep(UPrimitiveComponent* SleepingComponent, FName BoneName);
+
+	UFUNCTION()
+	void OnLockedItemHit(UPrimitiveComponent* HitComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, FVector NormalImpulse, const FHitResult& Hit);
+
+	//Updates the stats after a change
+	void UpdateStats();
+
+	//All followed items
+	TMap<TWeakObjectPtr<UPrimitiveComponent>, FSettleState> Bodies;
+
+	//Items currently awake, the only ones checked every frame
+	TArray<TWeakObjectPtr<UPrimitiveComponent>> AwakeBodies;
+
+	int32 NumLocked;
+	float LockCheckTime;
+};
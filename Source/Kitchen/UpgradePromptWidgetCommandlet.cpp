@@ -0,0 +1,83 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Kitchen.h"
+#include "UpgradePromptWidgetCommandlet.h"
+#include "InteractionPromptWidget.h"
+#if WITH_EDITOR
+#include "WidgetBlueprint.h"
+#include "Kismet2/BlueprintEditorUtils.h"
+#include "Kismet2/KismetEditorUtilities.h"
+#endif
+
+UUpgradePromptWidgetCommandlet::UUpgradePromptWidgetCommandlet()
+{
+	IsClient = false;
+	IsEditor = true;
+	LogToConsole = true;
+}
+
+int32 UUpgradePromptWidgetCommandlet::Main(const FString& Params)
+{
+#if WITH_EDITOR
+	FString WidgetPath = TEXT("/Game/Blueprints/InventoryHUD_BP");
+	FParse::Value(*Params, TEXT("Widget="), WidgetPath);
+
+	UWidgetBlueprint* Widget = LoadObject<UWidgetBlueprint>(nullptr, *WidgetPath);
+	if (!Widget)
+	{
+		UE_LOG(LogTemp, Error, TEXT("Could not load the widget %s"), *WidgetPath);
+		return 1;
+	}
+	Widget->Modify();
+
+	const UInteractionPromptWidget* Defaults = GetDefault<UInteractionPromptWidget>();
+	if (Widget->ParentClass != UInteractionPromptWidget::StaticClass())
+	{
+		UE_LOG(LogTemp, Display, TEXT("%s: parent %s replaced by %s"), *WidgetPath, *GetNameSafe(Widget->ParentClass), *UInteractionPromptWidget::StaticClass()->GetName());
+		Widget->ParentClass = UInteractionPromptWidget::StaticClass();
+	}
+
+	//The prompts are set on the event, a binding would still be evaluated every frame and override them
+	for (int32 Index = Widget->Bindings.Num() - 1; Index >= 0; Index--)
+	{
+		const FDelegateEditorBinding& Binding = Widget->Bindings[Index];
+		const FName ObjectName(*Binding.ObjectName);
+		if (ObjectName != Defaults->PromptTextName && ObjectName != Defaults->DetailTextName)
+		{
+			continue;
+		}
+
+		const FName FunctionName = Binding.FunctionName;
+		UE_LOG(LogTemp, Display, TEXT("%s: binding of %s.%s to %s removed"), *WidgetPath, *Binding.ObjectName, *Binding.PropertyName.ToString(), *FunctionName.ToString());
+		Widget->Bindings.RemoveAt(Index);
+
+		UEdGraph* const* Graph = Widget->FunctionGraphs.FindByPredicate([FunctionName](const UEdGraph* Candidate) { return Candidate && Candidate->GetFName() == FunctionName; });
+		if (Graph)
+		{
+			FBlueprintEditorUtils::RemoveGraph(Widget, *Graph, EGraphRemoveFlags::Recompile);
+		}
+	}
+
+	FBlueprintEditorUtils::RefreshAllNodes(Widget);
+	FKismetEditorUtilities::CompileBlueprint(Widget);
+	if (Widget->Status == BS_Error)
+	{
+		UE_LOG(LogTemp, Error, TEXT("%s does not compile after the upgrade, it is not saved"), *WidgetPath);
+		return 1;
+	}
+
+	UPackage* Package = Widget->GetOutermost();
+	const FString FileName = FPackageName::LongPackageNameToFilename(Package->GetName(), FPackageName::GetAssetPackageExtension());
+	if (!UPackage::SavePackage(Package, nullptr, RF_Standalone, *FileName))
+	{
+		UE_LOG(LogTemp, Error, TEXT("Could not save %s"), *FileName);
+		return 1;
+	}
+
+	UE_LOG(LogTemp, Display, TEXT("%s now shows the prompts from OnInteractionStateChanged"), *WidgetPath);
+	return 0;
+#else
+	UE_LOG(LogTemp, Error, TEXT("UpgradePromptWidget needs the editor"));
+	return 1;
+#endif
+}
@@ -0,0 +1,24 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "Commandlets/Commandlet.h"
+#include "UpgradePromptWidgetCommandlet.generated.h"
+
+/**
+ * Moves the HUD widget to the event driven prompts: reparents it to UInteractionPromptWidget,
+ * removes the property bindings of its prompt text blocks and the functions they called every
+ * frame, then compiles and saves it. Run once from the editor binary:
+ *   UE4Editor-Cmd.exe Kitchen.uproject -run=UpgradePromptWidget [-Widget=/Game/Blueprints/InventoryHUD_BP]
+ * Returns 1 if the widget could not be loaded, compiled or saved.
+ */
+UCLASS()
+class UUpgradePromptWidgetCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UUpgradePromptWidgetCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
@@ -0,0 +1,201 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Kitchen.h"
+#include "WorldSnapshotService.h"
+#include "InteractableRegistry.h"
+#include "InteractableComponent.h"
+#include "HandSlotComponent.h"
+#include "MyCharacter.h"
+#include "EngineUtils.h"
+
+using namespace KitchenSnapshot;
+
+AWorldSnapshotService::AWorldSnapshotService()
+{
+	//Published once the frame is done, when the items have moved
+	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.TickGroup = TG_PostUpdateWork;
+
+	UpdateRate = 30.f;
+
+	SharedMemory = nullptr;
+	Region = nullptr;
+	NextActorId = 0;
+}
+
+bool AWorldSnapshotService::IsSnapshotRequested()
+{
+	return FParse::Param(FCommandLine::Get(), TEXT("KitchenSnapshot"));
+}
+
+void AWorldSnapshotService::BeginPlay()
+{
+	Super::BeginPlay();
+
+	PrimaryActorTick.TickInterval = UpdateRate > 0.f ? 1.f / UpdateRate : 0.f;
+
+	SharedMemory = FPlatformMemory::MapNamedSharedMemoryRegion(ANSI_TO_TCHAR(RegionName), true, FPlatformMemory::ESharedMemoryAccess::Read | FPlatformMemory::ESharedMemoryAccess::Write, sizeof(FSnapshotRegion));
+	if (!SharedMemory)
+	{
+		UE_LOG(LogTemp, Error, TEXT("Kitchen snapshot service could not create the shared memory region %s"), ANSI_TO_TCHAR(RegionName));
+		SetActorTickEnabled(false);
+		return;
+	}
+
+	//The magic goes in last, readers ignore the region until it is there
+	Region = static_cast<FSnapshotRegion*>(SharedMemory->GetAddress());
+	FMemory::Memzero(Region, sizeof(FSnapshotRegion));
+	Region->Version = Version;
+	Region->RegionSize = sizeof(FSnapshotRegion);
+	Region->UpdateRate = UpdateRate;
+	std::atomic_thread_fence(std::memory_order_release);
+	Region->Magic = Magic;
+
+	UE_LOG(LogTemp, Log, TEXT("Kitchen snapshot service publishing %d bytes in %s at %.1f Hz"), static_cast<int32>(sizeof(FSnapshotRegion)), ANSI_TO_TCHAR(RegionName), UpdateRate);
+}
+
+void AWorldSnapshotService::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (SharedMemory)
+	{
+		Region->Magic = 0;
+		FPlatformMemory::UnmapNamedSharedMemoryRegion(SharedMemory);
+		SharedMemory = nullptr;
+		Region = nullptr;
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void AWorldSnapshotService::Tick(float DeltaSeconds)
+{
+	SCOPE_CYCLE_COUNTER(STAT_KitchenSnapshot);
+
+	Super::Tick(DeltaSeconds);
+
+	if (!Region)
+	{
+		return;
+	}
+
+	//Fill the slot after the latest one, readers still copying the latest are not disturbed
+	const uint64_t NumPublished = Region->NumPublished.load(std::memory_order_relaxed);
+	FSnapshotSlot& Slot = Region->Slots[NumPublished % NumSlots];
+
+	const uint32_t Sequence = Slot.Sequence.load(std::memory_order_relaxed);
+	Slot.Sequence.store(Sequence + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+
+	WriteSlot(Slot);
+
+	Slot.Sequence.store(Sequence + 2, std::memory_order_release);
+	Region->NumPublished.store(NumPublished + 1, std::memory_order_release);
+}
+
+void AWorldSnapshotService::WriteSlot(FSnapshotSlot& Slot)
+{
+	UWorld* World = GetWorld();
+	Slot.Frame = GFrameCounter;
+	Slot.Time = World->GetTimeSeconds();
+	Slot.NumItems = 0;
+	Slot.NumOpenables = 0;
+
+	AInteractableRegistry* Registry = AInteractableRegistry::FindInWorld(World);
+	if (!Registry)
+	{
+		return;
+	}
+
+	//Which hand carries which item
+	HeldBy.Reset();
+	for (TActorIterator<AMyCharacter> It(World); It; ++It)
+	{
+		if (It->RightHand && !It->RightHand->IsEmpty())
+		{
+			HeldBy.Add(It->RightHand->GetHeldItem(), KitchenSnapshot::RightHand);
+		}
+		if (It->LeftHand && !It->LeftHand->IsEmpty())
+		{
+			HeldBy.Add(It->LeftHand->GetHeldItem(), KitchenSnapshot::LeftHand);
+		}
+	}
+
+	Interactables.Reset();
+	Registry->GetInteractables(EInteractableKind::Item, Interactables);
+	for (const UInteractableComponent* Item : Interactables)
+	{
+		const int32 Id = GetActorId(Item->GetOwner());
+		if (Slot.NumItems == MaxItems || Id == INDEX_NONE || !Item->GetMesh())
+		{
+			continue;
+		}
+
+		const uint32 Index = Slot.NumItems++;
+		const FTransform& Transform = Item->GetMesh()->GetComponentTransform();
+		const FVector Location = Transform.GetLocation();
+		const FQuat Rotation = Transform.GetRotation();
+		const uint8* HeldHand = HeldBy.Find(Item);
+
+		Slot.ItemIds[Index] = Id;
+		Slot.PositionX[Index] = Location.X;
+		Slot.PositionY[Index] = Location.Y;
+		Slot.PositionZ[Index] = Location.Z;
+		Slot.RotationX[Index] = Rotation.X;
+		Slot.RotationY[Index] = Rotation.Y;
+		Slot.RotationZ[Index] = Rotation.Z;
+		Slot.RotationW[Index] = Rotation.W;
+		Slot.HeldBy[Index] = HeldHand ? *HeldHand : KitchenSnapshot::NotHeld;
+	}
+
+	Interactables.Reset();
+	Registry->GetInteractables(EInteractableKind::Openable, Interactables);
+	for (const UInteractableComponent* Openable : Interactables)
+	{
+		const int32 Id = GetActorId(Openable->GetOwner());
+		if (Slot.NumOpenables == MaxOpenables || Id == INDEX_NONE)
+		{
+			continue;
+		}
+
+		const uint32 Index = Slot.NumOpenables++;
+		Slot.OpenableIds[Index] = Id;
+		Slot.OpenableStates[Index] = static_cast<uint8>(Openable->AssetState);
+	}
+}
+
+int32 AWorldSnapshotService::GetActorId(const AActor* Actor)
+{
+	TWeakObjectPtr<AActor> Key(const_cast<AActor*>(Actor));
+	if (const int32* Id = ActorIds.Find(Key))
+	{
+		return *Id;
+	}
+
+	//Only reached when an actor is seen for the first time or its level was loaded again; the
+	//actors of unloaded levels are forgotten then
+	for (auto It = ActorIds.CreateIterator(); It; ++It)
+	{
+		if (!It.Key().IsValid())
+		{
+			It.RemoveCurrent();
+		}
+	}
+
+	const FString PathName = Actor->GetPathName();
+	if (const int32* Id = ActorIdsByPath.Find(PathName))
+	{
+		ActorIds.Add(Key, *Id);
+		return *Id;
+	}
+	if (NextActorId == static_cast<int32>(MaxIds))
+	{
+		return INDEX_NONE;
+	}
+
+	//The name is in place before any slot refers to the id
+	const int32 Id = NextActorId++;
+	FCStringAnsi::Strncpy(Region->Names[Id], TCHAR_TO_UTF8(*PathName), MaxNameLength);
+	ActorIdsByPath.Add(PathName, Id);
+	ActorIds.Add(Key, Id);
+	return Id;
+}
@@ -0,0 +1,62 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "GameFramework/Info.h"
+#include "KitchenSnapshotLayout.h"
+#include "WorldSnapshotService.generated.h"
+
+class UInteractableComponent;
+
+/**
+ * Publishes the pose of every item and the state of every drawer and door in a named shared
+ * memory region, at UpdateRate snapshots per second, so local analysis tools can follow the
+ * kitchen without calling into the game. The layout and the seqlock protocol are described in
+ * KitchenSnapshotLayout.h; tools read it with KitchenSnapshotReader.h.
+ * Started with -KitchenSnapshot.
+ */
+UCLASS(config = Game)
+class KITCHEN_API AWorldSnapshotService : public AInfo
+{
+	GENERATED_BODY()
+
+public:
+	AWorldSnapshotService();
+
+	//Returns true if the game was started with the snapshot service enabled
+	static bool IsSnapshotRequested();
+
+	// Called when the game starts or when spawned
+	virtual void BeginPlay() override;
+
+	// Called when the game ends or when destroyed
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	// Called UpdateRate times per second
+	virtual void Tick(float DeltaSeconds) override;
+
+	//Snapshots published per second, 0 publishes every frame
+	UPROPERTY(config)
+	float UpdateRate;
+
+private:
+	//Returns the id of an actor, writing its name in the region the first time; INDEX_NONE when the table is full
+	int32 GetActorId(const AActor* Actor);
+
+	//Fills a slot of the ring with the current state of the kitchen
+	void WriteSlot(KitchenSnapshot::FSnapshotSlot& Slot);
+
+	FPlatformMemory::FSharedMemoryRegion* SharedMemory;
+	KitchenSnapshot::FSnapshotRegion* Region;
+
+	//Ids of the actors named in the region, by path name, so an actor of a reloaded level gets its id back
+	TMap<FString, int32> ActorIdsByPath;
+	int32 NextActorId;
+
+	//Ids of the actors currently loaded, saves building their path every snapshot
+	TMap<TWeakObjectPtr<AActor>, int32> ActorIds;
+
+	//Reused every snapshot
+	TArray<UInteractableComponent*> Interactables;
+	TMap<const UInteractableComponent*, uint8> HeldBy;
+};
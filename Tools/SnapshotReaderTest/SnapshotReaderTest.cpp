@@ -0,0 +1,311 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+/**
+ * Standalone test of KitchenSnapshotReader.h, built without the engine:
+ *   g++ -std=c++11 -O2 -pthread -ISource/Kitchen Tools/SnapshotReaderTest/SnapshotReaderTest.cpp -o SnapshotReaderTest -lrt
+ *   cl /EHsc /O2 /ISource\Kitchen Tools\SnapshotReaderTest\SnapshotReaderTest.cpp
+ * A writer thread publishes snapshots into a shared memory region with the seqlock sequence of
+ * AWorldSnapshotService::Tick, filling every field of a slot from the number of the snapshot, while
+ * the main thread reads them with Visit() and ReadLatest(). A read accepted by the reader must never
+ * mix two snapshots, and must belong to a snapshot published between the start and the end of the read.
+ * Then a slot being written and a slot overwritten during a visit are checked to be refused.
+ * Returns 0 when every check passed.
+ */
+
+#include "KitchenSnapshotReader.h"
+
+#include <stdio.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace KitchenSnapshot;
+
+static const char* const TestRegionName = "KitchenSnapshotTest";
+static const uint64_t NumSnapshots = 200000;
+
+static int NumFailures = 0;
+
+static void Check(bool bCondition, const char* What, uint64_t Value)
+{
+	if (!bCondition)
+	{
+		if (NumFailures < 20)
+		{
+			printf("FAILED: %s (%llu)\n", What, static_cast<unsigned long long>(Value));
+		}
+		NumFailures++;
+	}
+}
+
+//Shared memory created by the test, like the game does with FPlatformMemory::MapNamedSharedMemoryRegion
+class FTestRegion
+{
+public:
+	FTestRegion()
+		: Region(nullptr)
+#if defined(_WIN32)
+		, Mapping(nullptr)
+#endif
+	{
+		void* Address = nullptr;
+#if defined(_WIN32)
+		Mapping = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, 0, sizeof(FSnapshotRegion), TestRegionName);
+		if (Mapping)
+		{
+			Address = MapViewOfFile(Mapping, FILE_MAP_ALL_ACCESS, 0, 0, sizeof(FSnapshotRegion));
+		}
+#else
+		const std::string PosixName = std::string("/") + TestRegionName;
+		shm_unlink(PosixName.c_str());
+		const int File = shm_open(PosixName.c_str(), O_RDWR | O_CREAT, 0600);
+		if (File >= 0 && ftruncate(File, sizeof(FSnapshotRegion)) == 0)
+		{
+			Address = mmap(nullptr, sizeof(FSnapshotRegion), PROT_READ | PROT_WRITE, MAP_SHARED, File, 0);
+			if (Address == MAP_FAILED)
+			{
+				Address = nullptr;
+			}
+		}
+		if (File >= 0)
+		{
+			close(File);
+		}
+#endif
+		Region = static_cast<FSnapshotRegion*>(Address);
+	}
+
+	~FTestRegion()
+	{
+#if defined(_WIN32)
+		if (Region)
+		{
+			UnmapViewOfFile(Region);
+		}
+		if (Mapping)
+		{
+			CloseHandle(Mapping);
+		}
+#else
+		if (Region)
+		{
+			munmap(Region, sizeof(FSnapshotRegion));
+		}
+		shm_unlink((std::string("/") + TestRegionName).c_str());
+#endif
+	}
+
+	FSnapshotRegion* Region;
+
+private:
+#if defined(_WIN32)
+	HANDLE Mapping;
+#endif
+};
+
+//Same initialization as AWorldSnapshotService::BeginPlay: the magic goes in last
+static void InitializeRegion(FSnapshotRegion* Region)
+{
+	memset(static_cast<void*>(Region), 0, sizeof(FSnapshotRegion));
+	Region->Version = Version;
+	Region->RegionSize = sizeof(FSnapshotRegion);
+	Region->UpdateRate = 0.f;
+	for (uint32_t Id = 0; Id < MaxIds; Id++)
+	{
+		snprintf(Region->Names[Id], MaxNameLength, "/Game/Test.Test:PersistentLevel.Actor_%u", Id);
+	}
+	std::atomic_thread_fence(std::memory_order_release);
+	Region->Magic = Magic;
+}
+
+//Every field of the slot is derived from the number of the snapshot, so a mix of two snapshots shows
+static void FillSlot(FSnapshotSlot& Slot, uint64_t Number)
+{
+	const float Value = static_cast<float>(Number % 1000000);
+	Slot.Frame = Number;
+	Slot.Time = static_cast<double>(Number);
+	Slot.NumItems = static_cast<uint32_t>(Number % (MaxItems + 1));
+	Slot.NumOpenables = static_cast<uint32_t>(Number % (MaxOpenables + 1));
+	for (uint32_t Index = 0; Index < MaxItems; Index++)
+	{
+		Slot.ItemIds[Index] = static_cast<uint32_t>(Number);
+		Slot.PositionX[Index] = Value;
+		Slot.PositionY[Index] = Value;
+		Slot.PositionZ[Index] = Value;
+		Slot.RotationX[Index] = Value;
+		Slot.RotationY[Index] = Value;
+		Slot.RotationZ[Index] = Value;
+		Slot.RotationW[Index] = Value;
+		Slot.HeldBy[Index] = static_cast<uint8_t>(Number % 3);
+	}
+	for (uint32_t Index = 0; Index < MaxOpenables; Index++)
+	{
+		Slot.OpenableIds[Index] = static_cast<uint32_t>(Number);
+		Slot.OpenableStates[Index] = static_cast<uint8_t>(Number % 3);
+	}
+}
+
+//Same publication as AWorldSnapshotService::Tick
+static void PublishSnapshot(FSnapshotRegion* Region)
+{
+	const uint64_t NumPublished = Region->NumPublished.load(std::memory_order_relaxed);
+	FSnapshotSlot& Slot = Region->Slots[NumPublished % NumSlots];
+
+	const uint32_t Sequence = Slot.Sequence.load(std::memory_order_relaxed);
+	Slot.Sequence.store(Sequence + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+
+	FillSlot(Slot, NumPublished + 1);
+
+	Slot.Sequence.store(Sequence + 2, std::memory_order_release);
+	Region->NumPublished.store(NumPublished + 1, std::memory_order_release);
+}
+
+//True if a snapshot read between two loads of the published count was published during the read; the
+//writer may have finished the next snapshot without publishing its count yet
+static bool IsPublishedDuring(uint64_t Number, uint64_t PublishedBefore, uint64_t PublishedAfter)
+{
+	return Number >= PublishedBefore && Number <= PublishedAfter + 1;
+}
+
+//Checks that a snapshot accepted by the reader is one snapshot, published during the read
+static void CheckSnapshot(const FSnapshotSlot& Snapshot, uint64_t PublishedBefore, uint64_t PublishedAfter)
+{
+	const uint64_t Number = Snapshot.Frame;
+	const float Value = static_cast<float>(Number % 1000000);
+
+	Check(IsPublishedDuring(Number, PublishedBefore, PublishedAfter), "snapshot published outside of the read", Number);
+	Check(Snapshot.Time == static_cast<double>(Number), "time of another snapshot", Number);
+	Check(Snapshot.NumItems == Number % (MaxItems + 1), "item count of another snapshot", Number);
+	Check(Snapshot.NumOpenables == Number % (MaxOpenables + 1), "openable count of another snapshot", Number);
+	for (uint32_t Index = 0; Index < MaxItems; Index++)
+	{
+		Check(Snapshot.ItemIds[Index] == static_cast<uint32_t>(Number) && Snapshot.PositionX[Index] == Value && Snapshot.PositionY[Index] == Value
+			&& Snapshot.PositionZ[Index] == Value && Snapshot.RotationX[Index] == Value && Snapshot.RotationY[Index] == Value
+			&& Snapshot.RotationZ[Index] == Value && Snapshot.RotationW[Index] == Value && Snapshot.HeldBy[Index] == Number % 3,
+			"torn item", Number);
+	}
+	for (uint32_t Index = 0; Index < MaxOpenables; Index++)
+	{
+		Check(Snapshot.OpenableIds[Index] == static_cast<uint32_t>(Number) && Snapshot.OpenableStates[Index] == Number % 3, "torn openable", Number);
+	}
+}
+
+int main()
+{
+	FTestRegion TestRegion;
+	if (!TestRegion.Region)
+	{
+		printf("FAILED: the shared memory region could not be created\n");
+		return 1;
+	}
+	InitializeRegion(TestRegion.Region);
+
+	FReader Reader;
+	Check(Reader.Open(TestRegionName), "the reader could not open the region", 0);
+	Check(Reader.IsLive(), "the region is not live", 0);
+	Check(Reader.GetNumPublished() == 0, "snapshots published before the writer started", Reader.GetNumPublished());
+	Check(strcmp(Reader.GetName(7), "/Game/Test.Test:PersistentLevel.Actor_7") == 0, "name table", 7);
+
+	FSnapshotSlot* Snapshot = new FSnapshotSlot();
+	Check(!Reader.ReadLatest(*Snapshot), "a snapshot was read before any was published", 0);
+
+	std::atomic<bool> bWriterDone(false);
+	std::thread Writer([&TestRegion, &bWriterDone]()
+	{
+		for (uint64_t Number = 0; Number < NumSnapshots; Number++)
+		{
+			PublishSnapshot(TestRegion.Region);
+		}
+		bWriterDone.store(true);
+	});
+
+	uint64_t NumVisited = 0;
+	uint64_t NumVisitsRejected = 0;
+	uint64_t NumCopied = 0;
+	uint64_t NumCopiesRejected = 0;
+	uint64_t LastPublished = 0;
+	std::vector<uint64_t> Gathered(MaxItems + MaxOpenables + 2);
+	while (!bWriterDone.load())
+	{
+		const uint64_t PublishedBefore = Reader.GetNumPublished();
+		Check(PublishedBefore >= LastPublished, "the published count went back", PublishedBefore);
+		LastPublished = PublishedBefore;
+		if (PublishedBefore == 0)
+		{
+			continue;
+		}
+
+		//In place: the visitor only gathers, the values are checked if the visit is accepted
+		uint64_t Number = 0;
+		const bool bVisited = Reader.Visit([&Gathered, &Number](const FSnapshotSlot& Slot)
+		{
+			Number = Slot.Frame;
+			for (uint32_t Index = 0; Index < MaxItems; Index++)
+			{
+				Gathered[Index] = Slot.ItemIds[Index];
+			}
+			for (uint32_t Index = 0; Index < MaxOpenables; Index++)
+			{
+				Gathered[MaxItems + Index] = Slot.OpenableIds[Index];
+			}
+		});
+		if (bVisited)
+		{
+			NumVisited++;
+			Check(IsPublishedDuring(Number, PublishedBefore, Reader.GetNumPublished()), "visited snapshot published outside of the visit", Number);
+			for (uint32_t Index = 0; Index < MaxItems + MaxOpenables; Index++)
+			{
+				Check(Gathered[Index] == static_cast<uint32_t>(Number), "torn visit", Number);
+			}
+		}
+		else
+		{
+			NumVisitsRejected++;
+		}
+
+		const uint64_t CopyBefore = Reader.GetNumPublished();
+		if (Reader.ReadLatest(*Snapshot, 1))
+		{
+			NumCopied++;
+			CheckSnapshot(*Snapshot, CopyBefore, Reader.GetNumPublished());
+		}
+		else
+		{
+			NumCopiesRejected++;
+		}
+	}
+	Writer.join();
+
+	//Once the writer stopped every read succeeds and returns the last snapshot
+	Check(Reader.GetNumPublished() == NumSnapshots, "published count at the end", Reader.GetNumPublished());
+	Check(Reader.ReadLatest(*Snapshot), "the last snapshot could not be read", 0);
+	CheckSnapshot(*Snapshot, NumSnapshots, NumSnapshots);
+	Check(Snapshot->Frame == NumSnapshots, "the last snapshot is not the latest", Snapshot->Frame);
+
+	//A slot being written is refused
+	FSnapshotSlot& Latest = TestRegion.Region->Slots[(NumSnapshots - 1) % NumSlots];
+	const uint32_t Sequence = Latest.Sequence.load();
+	Latest.Sequence.store(Sequence + 1);
+	Check(!Reader.ReadLatest(*Snapshot), "a slot being written was read", Sequence);
+	Check(!Reader.Visit([](const FSnapshotSlot&) {}), "a slot being written was visited", Sequence);
+	Latest.Sequence.store(Sequence);
+
+	//A slot overwritten while it is visited is refused, the writer lapped the ring during the visit
+	const bool bLappedVisit = Reader.Visit([&TestRegion](const FSnapshotSlot&)
+	{
+		for (uint32_t Slot = 0; Slot < NumSlots; Slot++)
+		{
+			PublishSnapshot(TestRegion.Region);
+		}
+	});
+	Check(!bLappedVisit, "a visit of an overwritten slot was accepted", NumSnapshots);
+	Check(Reader.ReadLatest(*Snapshot) && Snapshot->Frame == NumSnapshots + NumSlots, "the snapshot after the lap", Snapshot->Frame);
+	delete Snapshot;
+
+	printf("%llu snapshots published; visits: %llu accepted, %llu rejected; copies: %llu accepted, %llu rejected\n",
+		static_cast<unsigned long long>(NumSnapshots), static_cast<unsigned long long>(NumVisited), static_cast<unsigned long long>(NumVisitsRejected),
+		static_cast<unsigned long long>(NumCopied), static_cast<unsigned long long>(NumCopiesRejected));
+	printf(NumFailures == 0 ? "PASSED\n" : "FAILED: %d checks\n", NumFailures);
+	return NumFailures == 0 ? 0 : 1;
+}